@@ -15,6 +15,12 @@ void setLEDs(int);                           // Set the keyboard LEDs
 int  sendframe(void);                        // Send a frame to the ZVG
 void ShutdownAll(void);                      // Shut down everything
 void drawvector(point, point, float, float); // draw a vector between 2 points
+void drawxform(vmatrix*, float, float, float, float); // draw a vector through a transform
+void drawpolyline(vmatrix*, const point*, int); // draw joined vectors through points, via a transform
+int  layer_begin(int, int);                  // start drawing a layer, always redrawn here
+void layer_end(void);                        // end of a layer
+void zvgFrameStallStats(unsigned int*, unsigned int*);    // no driver stats here, always 0
+void zvgFrameOverflowStats(unsigned int*, unsigned int*); // no driver stats here, always 0
 void RunGame(char*);                         // Start MAME with a gamename
 void mousepos(int*, int*);                   // Get the position of the mouse
 int  GetModifierStatus(void);                // Get status of modifier keys
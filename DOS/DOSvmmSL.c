@@ -328,6 +328,79 @@ void drawvector(point p1, point p2, float x_trans, float y_trans)
 }
 
 
+/*******************************************************************
+ Draw a vector from x1,y1 to x2,y2 through transform m, which
+ already includes the screen rotation (see screenmatrix())
+********************************************************************/
+void drawxform(vmatrix *m, float x1, float y1, float x2, float y2)
+{
+   zvgFrameVector(m->a * x1 + m->b * y1 + m->tx, m->c * x1 + m->d * y1 + m->ty,
+                  m->a * x2 + m->b * y2 + m->tx, m->c * x2 + m->d * y2 + m->ty);
+}
+
+
+/*******************************************************************
+ Draw lines joining n points, through transform m, which already
+ includes the screen rotation. A point with x of PEN_UP lifts the
+ pen, and the next line starts at the point after it. Each point
+ is transformed once.
+********************************************************************/
+void drawpolyline(vmatrix *m, const point *p, int n)
+{
+   int   i, down = 0;
+   float x, y, lx = 0, ly = 0;
+   for (i = 0; i < n; i++, p++)
+   {
+      if (p->x == PEN_UP)
+      {
+         down = 0;
+         continue;
+      }
+      x = m->a * p->x + m->b * p->y + m->tx;
+      y = m->c * p->x + m->d * p->y + m->ty;
+      if (down) zvgFrameVector(lx, ly, x, y);
+      lx = x;
+      ly = y;
+      down = 1;
+   }
+}
+
+
+/*******************************************************************
+ Start drawing a layer of the screen. There is no layer cache here,
+ so every layer is drawn in full every frame.
+********************************************************************/
+int layer_begin(int layer, int redraw)
+{
+   return 1;
+}
+
+
+/*******************************************************************
+ End of a layer started by layer_begin()
+********************************************************************/
+void layer_end(void)
+{
+}
+
+/*******************************************************************
+ The DOS ZVG SDK doesn't count frames that waited or didn't fit,
+ so there is nothing for the detail level to go on, and it stays
+ at full detail.
+********************************************************************/
+void zvgFrameStallStats(unsigned int *frames, unsigned int *ms)
+{
+   *frames = 0;
+   *ms = 0;
+}
+
+void zvgFrameOverflowStats(unsigned int *frames, unsigned int *bytes)
+{
+   *frames = 0;
+   *bytes = 0;
+}
+
+
 /********************************************************************
    (Optionally) close ZVG and execute MAME, restart ZVG when done
 ********************************************************************/
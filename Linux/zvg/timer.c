@@ -7,14 +7,20 @@
 * History:
 *
 * 100623 Updated by Steve Johnson for Windows
+* 261016 Sleep most of the wait in tmrWaitForFrame() instead of spinning,
+*        keep frame pacing statistics, tmrTestMillis() was counting in us.
 *
 * (c) Copyright 2002-2010, Zektor, LLC.  All Rights Reserved.
 *****************************************************************************/
 #include	<time.h> //SCJ: for LINUX equivalent of Windows HRT.
+#include	<errno.h>
+#include	<string.h>
 #include	"timer.h"
 
-static long long int	frameZeroTime, ticksInFrame, ticksPerMs, frequency;
+static long long int	frameZeroTime, ticksInFrame, ticksPerMs, frequency, spinTicks;
 static unsigned int		frameCount = 0;
+static tmrStats_t		stats;
+static unsigned int		lateHist[TMR_HIST_SIZE];	// wake up lateness, in TMR_HIST_US buckets
 
 /******************************************************
  *  We still need an init function to set the frequency
@@ -23,8 +29,9 @@ int tmrInit(void)
 {
 	// LINUX timer is in nanoseconds (1/1000 ms)
 
-	ticksPerMs = (long long int)1000;	 // ticks per millisecond
+	ticksPerMs = (long long int)1000000;	 // ticks per millisecond
 	frequency  = (long long int)1000000000; // ticks per second
+	spinTicks  = (long long int)TMR_SPIN_US * 1000;	// spin for the end of each frame
 
 	return 1;
 }
@@ -41,7 +48,7 @@ long long int tmrReadTimer(void)
 	long long int thetime;
 	struct timespec time_now;
 
-	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time_now);
+	clock_gettime(CLOCK_MONOTONIC, &time_now);	// not CPU time, or sleeping would stop the clock
 
 	thetime = (long long int)((time_now.tv_sec * frequency) + (time_now.tv_nsec));
 
@@ -68,6 +75,36 @@ void tmrSetFrameRate(int fps)
 
 	ticksInFrame = frequency / (long long int)fps;
 	frameZeroTime = tmrReadTimer();
+
+	memset( &stats, 0, sizeof(stats));
+	memset( lateHist, 0, sizeof(lateHist));
+	stats.fps = fps;
+}
+
+/*****************************************************************************
+* Sleep until the timer reaches 'timer' (a value from 'tmrReadTimer()').
+*
+* The wake up may be late by the scheduler's granularity, so callers sleep
+* to a little before their deadline and spin for the rest.
+*****************************************************************************/
+static void tmrSleepUntil( long long int timer)
+{
+#if defined(__WIN32__) || defined(_WIN32)
+	long long int	ms;
+
+	// Sleep() counts whole ms, SDL sets the system timer to 1ms resolution
+	ms = (timer - tmrReadTimer()) / ticksPerMs;
+	if (ms > 0)
+		Sleep( (DWORD)ms);
+#else
+	struct timespec	ts;
+
+	ts.tv_sec  = (time_t)(timer / frequency);
+	ts.tv_nsec = (long)(timer % frequency);
+
+	while (clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+#endif
 }
 
 /*****************************************************************************
@@ -119,13 +156,66 @@ unsigned int tmrNumberFramesSkipped(void)
 unsigned int tmrWaitForFrame(void)
 {
 	unsigned int	frames = 0;
+	long long int	late;
 
-	while ((frames = tmrNumberFramesSkipped()) == 0)
-		;
+	// Frame boundaries are fixed multiples of the frame time from the datum,
+	// so a late wake up is made up on the next frame rather than carried
+	// forward. Sleep to just short of the boundary, then spin onto it.
+
+	if ((frames = tmrNumberFramesSkipped()) == 0)
+	{
+		tmrSleepUntil( frameZeroTime + ticksInFrame - spinTicks);
+
+		while ((frames = tmrNumberFramesSkipped()) == 0)
+			;
+	}
+
+	// Keep track of how far past the boundary we got
+
+	late = (tmrReadTimer() - frameZeroTime) * 1000000 / frequency;
+
+	stats.frames++;
+	stats.missed += frames - 1;
+	stats.lateSum += late;
+
+	if (late > stats.lateMax)
+		stats.lateMax = late;
+
+	lateHist[(late / TMR_HIST_US < TMR_HIST_SIZE) ? late / TMR_HIST_US : TMR_HIST_SIZE - 1]++;
 
 	return (frames);
 }
 
+/*****************************************************************************
+* Get the frame pacing statistics collected since the frame rate was set.
+*
+* 'lateP99' is worked out here from a histogram, so is only as fine as
+* TMR_HIST_US.
+*****************************************************************************/
+void tmrGetStats( tmrStats_t *aStats)
+{
+	unsigned int	ii, count, limit;
+
+	*aStats = stats;
+	aStats->lateP99 = 0;
+
+	if (stats.frames == 0)
+		return;
+
+	limit = stats.frames - stats.frames / 100;
+	count = 0;
+
+	for (ii = 0; ii < TMR_HIST_SIZE; ii++)
+	{
+		count += lateHist[ii];
+
+		if (count >= limit)
+		{	aStats->lateP99 = (long long int)(ii + 1) * TMR_HIST_US;
+			break;
+		}
+	}
+}
+
 /*****************************************************************************
 * Simple Accessor.  Gets the number of ticks in a frame.
 *
@@ -7,6 +7,8 @@
 * Created: 06/30/03
 *
 * History:
+*    10/16/26
+*       Show the /dev/parport device when the port is used through ppdev.
 *
 * (c) Copyright 2002-2004, Zektor, LLC.  All Rights Reserved.
 *****************************************************************************/
@@ -44,7 +46,11 @@ void zvgBanner( ZvgSpeeds_a speeds, ZvgID_s *id)
 
 	// print banner
 
-	fprintf( stdout, "\nZVG found on PORT=%03X, ", port);
+	if (ZvgIO.ops == &ZvgPpdevOps)
+		fprintf( stdout, "\nZVG found on /dev/parport%u, ", port);
+
+	else
+		fprintf( stdout, "\nZVG found on PORT=%03X, ", port);
 
 	//if (dmaMode != 0)
 	//	fprintf( stdout, "DMA=%u, DMA Mode=%u, IRQ=%u.", dma, dmaMode, irq);
@@ -5,6 +5,11 @@
 * Created: 11/06/02
 *
 * History:
+*   10/16/26
+*      Vectors with both ends inside the clip window skip 'clipLine()',
+*      which leaves them as they are anyway. Ratios are worked out with a
+*      table of reciprocals instead of a divide. Output is unchanged.
+*
 *   07/02/03
 *      Moved spot kill logic here.  Added 'zvgSOF()' to allow start a frame
 *      with spot kill dots if needed.  Changed the spotkill algorith one
@@ -68,6 +73,20 @@
 	ZvgENC.encBfr[ZvgENC.encCount++] = (uchar)(ratio & 0xF0) | ((len >> 8) & 0x0F), \
 	ZvgENC.encBfr[ZvgENC.encCount++] = (uchar)len
 
+// Ratio of the shorter length of a vector to the longer, as a 16 bit
+// fraction. Lengths are at most 12 bits, and for those multiplying by
+// 'RatioTab[den]' gives exactly the same result as '(num << 16) / den'.
+
+#define	RATIO_SHIFT		40
+#define	RATIO_MAX		4096			// lengths covered by 'RatioTab[]'
+
+#define	RATIO( num, den) \
+	(uint)((((unsigned long long)(num) << 16) * RatioTab[den]) >> RATIO_SHIFT)
+
+#define	INSIDE_CLIP( xx, yy) \
+	((xx) >= ZvgENC.xMinClip && (xx) <= ZvgENC.xMaxClip && \
+	 (yy) >= ZvgENC.yMinClip && (yy) <= ZvgENC.yMaxClip)
+
 #define	CHECK_X_SPOT( xx) \
    { \
 		if (xx < ZvgENC.xMinSpot) ZvgENC.xMinSpot = xx; \
@@ -82,6 +101,8 @@
 
 ZvgEnc_s		ZvgENC;					// Encoder information structure
 
+static unsigned long long	RatioTab[RATIO_MAX];	// (1 << RATIO_SHIFT) / length, rounded up
+
 /*****************************************************************************
 * This routine does one iteration of line clipping and is part of the
 * Liang-Barsky algorithm described in the book "Computer Graphics - 
@@ -199,6 +220,8 @@ static int clipLine( int *xStart, int *yStart, int *xEnd, int *yEnd)
 *****************************************************************************/
 void zvgEncReset( void)
 {
+	uint	ii;
+
 	// Reset ZVG status to same as ZVG at power on.
 
 	ZvgENC.xPos = 0;		  			// set to center
@@ -206,6 +229,13 @@ void zvgEncReset( void)
 
 	ZvgENC.zColor = zINIT_COLOR;	// initial color used by ZVG
 
+	// Build the reciprocal table used for ratios
+
+	if (RatioTab[1] == 0)
+	{	for (ii = 1; ii < RATIO_MAX; ii++)
+			RatioTab[ii] = ((1ULL << RATIO_SHIFT) / ii) + 1;
+	}
+
 	// Reset clipping window to maximum overscan
 
 	ZvgENC.xMinClip = X_MIN_O;
@@ -630,7 +660,7 @@ static void _zvgEncPoint_( int xStart, int yStart, uint color)
 
 			// calculate integer ratio
 
-			vRatio = (unsigned int)(((long)yLen << 16) / xLen);
+			vRatio = RATIO( yLen, xLen);
 
 			// send color if needed
 		
@@ -661,7 +691,7 @@ static void _zvgEncPoint_( int xStart, int yStart, uint color)
 
 			// calculate ratio
 
-			vRatio = (unsigned int)(((long)xLen << 16) / yLen);
+			vRatio = RATIO( xLen, yLen);
 
 			// send color if needed
 		
@@ -783,11 +813,13 @@ void zvgEnc( int xStart, int yStart, int xEnd, int yEnd)
 	}
 
 	// Check if NOT a point, vertical or horizontal line, then
-	// clip the line the old fashion way.
+	// clip the line the old fashion way. A line with both ends inside the
+	// clip window would come back unchanged, so don't bother.
 
 	if (xStart != xEnd && yStart != yEnd)
-		if (!clipLine( &xStart, &yStart, &xEnd, &yEnd))
-			return;								// if vector rejected, just return
+		if (!INSIDE_CLIP( xStart, yStart) || !INSIDE_CLIP( xEnd, yEnd))
+			if (!clipLine( &xStart, &yStart, &xEnd, &yEnd))
+				return;							// if vector rejected, just return
 
 	// Check for point
 
@@ -1120,7 +1152,7 @@ void zvgEnc( int xStart, int yStart, int xEnd, int yEnd)
 		{
 			// calculate integer ratio
 
-			vRatio = (uint)(((ulong)yLen << 16) / xLen);
+			vRatio = RATIO( yLen, xLen);
 
 			// if length can fit in 7 bits, send short version of command
 
@@ -1156,7 +1188,7 @@ void zvgEnc( int xStart, int yStart, int xEnd, int yEnd)
 		{
 			// calculate ratio
 
-			vRatio = (unsigned int)(((long)xLen << 16) / yLen);
+			vRatio = RATIO( xLen, yLen);
 
 			// if length can fit in 7 bits, send short version of command
 
@@ -8,6 +8,9 @@
 * Created: 05/21/03
 *
 * History:
+*    10/16/26
+*       Added 'errPpdev'.
+*
 *    07/03/03
 *       Rewrote error messages to be less generic and a bit more like help
 *       messages.
@@ -177,6 +180,11 @@ void zvgError( uint err)
 	case errIOPL:
 		fputs( "iopl(3) error- Unable to claim parallel port\n", stdout);
 		break;
+
+	case errPpdev:
+		fputs( "Unable to open or claim the /dev/parport device given by 'Nx' in\n", stdout);
+		fputs( "     'ZVGPORT='. Check the ppdev module is loaded and you can write to it.", stdout);
+		break;
 	}
 	fputs( "\n", stdout);
 	fflush( stdout);
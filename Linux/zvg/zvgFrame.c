@@ -5,6 +5,25 @@
 * Created:      05/20/03
 *
 * History:
+*    10/16/26
+*       Added 'zvgFrameRepeat()', an unchanged frame is resent from the last
+*       DMA buffer with 'zvgDmaSendPrev()' rather than being encoded again.
+*       See 'zvgFrameRepeatStats()'.
+*
+*    10/16/26
+*       Frames are sent by the port driver's transmit thread, so the next
+*       frame is built while the last one goes out. Added
+*       'zvgFrameStallStats()'.
+*
+*    10/16/26
+*       Frames are no longer cut short at MEM_BFR_SZ, the DMA buffers grow
+*       to fit. Vectors past MEM_BFR_MAX are dropped whole and counted,
+*       see 'zvgFrameOverflowStats()'.
+*
+*    10/16/26
+*       Added 'zvgFrameVectors()', encodes a batch of vectors straight
+*       into the DMA buffer.
+*
 *    07/02/03
 *       Moved spotkiller logic to zvgEnc.c. Added calls to 'zvgSOF()' to
 *       handle spotkiller.
@@ -36,6 +55,7 @@
 #include	"zstddef.h"
 #include	"zvgPort.h"
 #include	"zvgEnc.h"
+#include	"zvgFrame.h"
 //#include	"zvgError.h"
 
 #define	MAME										// if set, indicate this compile is to be used with MAME
@@ -45,12 +65,29 @@
 
 uchar			EncodeBfr[zENC_CMD_SIZE*10];
 
+// Room kept free at the end of a full DMA buffer, so the end of frame can
+// always be added.
+
+#define	EOF_ROOM	(sizeof( EncodeBfr))
+
 // Keep track of status information returned from the ZVG
 
 ZvgSpeeds_a	ZvgSpeeds;
 ZvgMon_s	ZvgMon;
 ZvgID_s		ZvgID;
 
+// Keep track of vectors that would not fit in the DMA buffer
+
+static uint	FrameDropped;				// bytes dropped from the frame being built
+static uint	OverflowFrames;			// frames that had vectors dropped
+static uint	OverflowBytes;				// bytes dropped from those frames
+
+// Keep track of unchanged frames resent from the last DMA buffer
+
+static bool	PrevValid;					// the last DMA buffer sent holds a whole frame
+static bool	RepeatNext;					// next 'zvgFrameSend()' resends it
+static uint	RepeatFrames;				// frames resent without being encoded
+
 /*****************************************************************************
 * Intialize the ZVG, setup DMA buffers, etc.
 *
@@ -61,6 +98,9 @@ uint zvgFrameOpen( void)
 
 	uint	err;
 
+	PrevValid = zFalse;
+	RepeatNext = zFalse;
+
 	// look for the ZVG
 
 	err = zvgInit();
@@ -104,6 +144,10 @@ uint zvgFrameOpen( void)
 		{	ZvgENC.encFlags |= ENCF_NOOVS;
 			zvgEncSetClipNoOverscan();
 		}
+
+		// from here on only frames are sent, so send them in the background
+
+		zvgDmaAsync( zTrue);
 	}
 
 	if (err)
@@ -159,9 +203,17 @@ uint zvgFrameVector( uint xStart, uint yStart, uint xEnd, uint yEnd)
 
 	zvgEnc( xStart, yStart, xEnd, yEnd);
 
-	// move encoded ZVG command into DMA buffer
+	// move encoded ZVG command into DMA buffer, unless that would leave no
+	// room to end the frame
 
-	err = zvgDmaPutMem( EncodeBfr, zvgEncSize());
+	if ((ZvgIO.dmaCurCount + zvgEncSize()) > (MEM_BFR_MAX - EOF_ROOM))
+		err = errBfrFull;
+
+	else
+		err = zvgDmaPutMem( EncodeBfr, zvgEncSize());
+
+	if (err)
+		FrameDropped += zvgEncSize();
 
 	// clear the encode buffer
 
@@ -170,6 +222,154 @@ uint zvgFrameVector( uint xStart, uint yStart, uint xEnd, uint yEnd)
 	return (err);
 }
 
+/*****************************************************************************
+* Encode and Send a batch of vectors to the DMA buffer.
+*
+* Gives exactly the same result as calling 'zvgFrameVector()' for each vector
+* in turn, but while there is room for a whole command the encoder writes
+* straight into the DMA buffer, rather than going through 'EncodeBfr[]'.
+*
+* Called with:
+*    vv = Array of vectors, see 'zvgFrameVector()' for coordinates.
+*    nn = Number of vectors in the array.
+*****************************************************************************/
+uint zvgFrameVectors( const vec_t *vv, size_t nn)
+{
+	size_t	room;
+	uint	limit, err;
+
+	// Grow the DMA buffer for the whole batch up front, as far as it will go
+
+	limit = MEM_BFR_MAX - EOF_ROOM;
+
+	if (ZvgIO.dmaCurCount < limit)
+	{	room = (limit - ZvgIO.dmaCurCount) / zENC_CMD_SIZE;
+		zvgDmaReserve( ((nn < room) ? nn : room) * zENC_CMD_SIZE);
+	}
+
+	if (limit > ZvgIO.dmaCurSize)
+		limit = ZvgIO.dmaCurSize;
+
+	while (nn > 0)
+	{	room = 0;
+
+		if (ZvgIO.dmaCurCount < limit)
+			room = (limit - ZvgIO.dmaCurCount) / zENC_CMD_SIZE;
+
+		if (room == 0)
+			break;
+
+		if (room > nn)
+			room = nn;
+
+		nn -= room;
+
+		zvgEncSetPtr( &ZvgIO.dmaCurP[ZvgIO.dmaCurCount]);
+
+		for (; room > 0; room--, vv++)
+			zvgEnc( vv->xStart, vv->yStart, vv->xEnd, vv->yEnd);
+
+		ZvgIO.dmaCurCount += zvgEncSize();
+		zvgEncSetPtr( EncodeBfr);				// back to the local encode buffer
+	}
+
+	// Buffer is full, let 'zvgFrameVector()' grow it or drop the rest
+
+	err = errOk;
+
+	for (; nn > 0; nn--, vv++)
+		err = zvgFrameVector( vv->xStart, vv->yStart, vv->xEnd, vv->yEnd);
+
+	return (err);
+}
+
+/*****************************************************************************
+* Encode and Send a strip of joined vectors to the DMA buffer.
+*
+* The vectors run from each point to the next. The encoder already leaves out
+* the start of a vector that begins where the last one ended, so the strip is
+* passed to 'zvgFrameVectors()' a chunk at a time.
+*
+* Called with:
+*    xy = Array of points, as X,Y pairs, see 'zvgFrameVector()' for coordinates.
+*    nn = Number of points in the array.
+*****************************************************************************/
+uint zvgFrameStrip( const int *xy, size_t nn)
+{
+	vec_t	vv[64];
+	size_t	ii, count;
+	uint	err;
+
+	err = errOk;
+	count = 0;
+
+	for (ii = 1; ii < nn; ii++)
+	{	vv[count].xStart = xy[ii*2 - 2];
+		vv[count].yStart = xy[ii*2 - 1];
+		vv[count].xEnd = xy[ii*2];
+		vv[count].yEnd = xy[ii*2 + 1];
+
+		if (++count == sizeof( vv) / sizeof( *vv))
+		{	err = zvgFrameVectors( vv, count);
+			count = 0;
+		}
+	}
+
+	if (count)
+		err = zvgFrameVectors( vv, count);
+
+	return (err);
+}
+
+/*****************************************************************************
+* Return the number of frames that were ready before the previous one had
+* been sent, and the total time (in ms) spent waiting for it.
+*****************************************************************************/
+void zvgFrameStallStats( uint *frames, uint *ms)
+{
+	zvgDmaStallStats( frames, ms);
+}
+
+/*****************************************************************************
+* Return the number of frames that had vectors dropped because the DMA
+* buffer could not hold them, and the number of bytes dropped.
+*****************************************************************************/
+void zvgFrameOverflowStats( uint *frames, uint *bytes)
+{
+	*frames = OverflowFrames;
+	*bytes = OverflowBytes;
+}
+
+/*****************************************************************************
+* Return the number of unchanged frames that were resent from the last DMA
+* buffer rather than encoded again, and the number of bytes that were not
+* sent because of them. The ZVG only draws what it is sent, so every repeat
+* still goes to the port, and no bytes are saved.
+*****************************************************************************/
+void zvgFrameRepeatStats( uint *frames, uint *bytes)
+{
+	*frames = RepeatFrames;
+	*bytes = 0;
+}
+
+/*****************************************************************************
+* Make the next frame a repeat of the last one sent.
+*
+* The next call to 'zvgFrameSend()' sends the last DMA buffer again with
+* 'zvgDmaSendPrev()', so the caller can skip building a frame it knows is
+* the same as the last. Nothing may be added to the frame before then.
+*
+* Returns:
+*    zTrue if the next frame will be a repeat, zFalse if there is no whole
+*    frame to repeat (none sent yet, or vectors were dropped from it) and
+*    the frame must be built as usual.
+*****************************************************************************/
+bool zvgFrameRepeat( void)
+{
+	RepeatNext = PrevValid;
+	return (RepeatNext);
+}
+
 /*****************************************************************************
 * Send the current buffer to the ZVG.
 *****************************************************************************/
@@ -177,6 +377,22 @@ uint zvgFrameSend(void)
 {
 	uint	err;
 
+	if (RepeatNext)
+	{	RepeatNext = zFalse;
+		RepeatFrames++;
+		return (zvgDmaSendPrev());		// current buffer still only holds the start of frame
+	}
+
+	// a frame with vectors dropped is always built again, so they are counted
+
+	PrevValid = (FrameDropped == 0);
+
+	if (FrameDropped)
+	{	OverflowFrames++;
+		OverflowBytes += FrameDropped;
+		FrameDropped = 0;
+	}
+
 	// Send End of Frame info. (Center Trace, pad ZVG buffer)
 	zvgEncEOF();
 
@@ -28,10 +28,21 @@
 #include	"timer.h"
 #endif
 
+#include	<stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// A vector for 'zvgFrameVectors()'
+
+typedef struct VEC_S
+{	int		xStart;
+	int		yStart;
+	int		xEnd;
+	int		yEnd;
+} vec_t;
+
 // Setup some aliases to make the API consistent.
 
 #define	zvgFrameSetColor( newcolor) \
@@ -63,7 +74,13 @@ extern ZvgID_s			ZvgID;
 extern uint zvgFrameOpen( void);
 extern void zvgFrameClose( void);
 extern uint zvgFrameVector( uint xStart, uint yStart, uint xEnd, uint yEnd);
+extern uint zvgFrameVectors( const vec_t *vv, size_t nn);
+extern uint zvgFrameStrip( const int *xy, size_t nn);
 extern uint zvgFrameSend(void);
+extern void zvgFrameOverflowStats( uint *frames, uint *bytes);
+extern void zvgFrameStallStats( uint *frames, uint *ms);
+extern bool zvgFrameRepeat( void);
+extern void zvgFrameRepeatStats( uint *frames, uint *bytes);
 
 #ifdef __cplusplus
 }
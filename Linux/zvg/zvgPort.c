@@ -6,6 +6,33 @@
 * Created: 11/06/02
 *
 * History:
+*    10/16/26
+*       With ZVGSIM defined the port is simulated (zvgSim.c), and if
+*       'ZVGPORT=' gives no port the simulated one at ZVGSIM_PORT is used.
+*
+*    10/16/26
+*       Port access goes through 'ZvgIO.ops'. Port I/O is still used for
+*       'ZVGPORT=Pxxx', 'ZVGPORT=Nx' uses /dev/parportx through ppdev, so
+*       root is no longer needed. Raw port I/O code is now only in
+*       'zvgDetectECP()' and the 'raw...()' routines.
+*
+*    10/16/26
+*       Added a transmit thread, started with 'zvgDmaAsync()'. While it
+*       runs, 'zvgDmaSendSwap()' and 'zvgDmaSendPrev()' return as soon as
+*       the buffer is handed over, so the next frame is built while this
+*       one is sent. Waits for the previous buffer are counted, see
+*       'zvgDmaStallStats()'.
+*
+*    10/16/26
+*       'zvgDetectECP()' measures the depth of the ECP FIFO, and
+*       'zvgEcpPutMem()' (so also frames) fills the whole FIFO each time
+*       it's found empty rather than testing ECR before every byte.
+*
+*    10/16/26
+*       DMA buffers now grow, up to MEM_BFR_MAX, rather than truncating
+*       large frames at MEM_BFR_SZ. Added 'zvgDmaReserve()'. Data that
+*       still does not fit is refused whole, never split mid command.
+*
 *    07/01/03
 *       Added a bit to monitor type in 'ZVGPORT=' to indicate a B&W monitor
 *       is connected to the ZVG, to allow Color to B&W mix down.
@@ -29,12 +56,15 @@
 *
 * (c) Copyright 2002-2004, Zektor, LLC.  All Rights Reserved.
 *****************************************************************************/
+#ifndef ZVGSIM
 #include	<sys/io.h>
+#endif
 
 #include	<stdlib.h>
 #include	<string.h>
 #include	<ctype.h>
 #include	<stdio.h>
+#include	<pthread.h>
 
 #include	"zstddef.h"
 #include	"zvgCmds.h"
@@ -46,6 +76,18 @@ ZvgIO_s	ZvgIO;							// Structure used to communicate with ZVG
 
 static const uchar IrqLookup[] = { 0, 7, 9, 10, 11, 14, 15, 5};
 
+// Transmit thread, sends one DMA buffer while the other is being filled
+
+static pthread_t		XmtThread;
+static pthread_mutex_t	XmtLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	XmtCond = PTHREAD_COND_INITIALIZER;
+static bool				XmtRunning;				// set while the transmit thread is running
+static uchar			*XmtMem;					// buffer being sent, 0 when idle
+static uint				XmtCount;				// count of bytes in that buffer
+static uint				XmtErr;					// error from the last buffer sent
+static uint				XmtStalls;				// frames that had to wait for the previous one
+static long long int	XmtStallTime;			// timer ticks spent waiting
+
 /*****************************************************************************
 * Wait for the DSR to equal the given value.
 *
@@ -72,7 +114,7 @@ static uint waitForDsrEQ( uchar mask, uchar bitVal, ulong ms)
 
 	do
 	{
-		if (((readVal = inportb( ZvgIO.ecpDsr)) & mask) == testVal)
+		if (((readVal = ZvgIO.ops->rdsr()) & mask) == testVal)
 		{	foundF = zTrue;				// indicate match was found
 			break;
 		}
@@ -109,7 +151,7 @@ static uint	waitForDsrNE( uchar mask, uchar bitVal, ulong ms)
 	timer = tmrReadTimer();
 	do
 	{
-		if (((readVal = inportb( ZvgIO.ecpDsr)) & mask) != testVal)
+		if (((readVal = ZvgIO.ops->rdsr()) & mask) != testVal)
 		{	foundF = zTrue;
 			break;
 		}
@@ -164,7 +206,7 @@ static void sdcr( uchar bits)
 {
 	ZvgIO.ecpDcrState |= bits;								// set control bits
 	ZvgIO.ecpDcrState ^= DCR_InvMask & bits;			// invert them if needed
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState);		// set new control line values
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState);				// set new control line values
 }
 
 /*****************************************************************************
@@ -174,7 +216,7 @@ static void cdcr( uchar bits)
 {
 	ZvgIO.ecpDcrState &= ~bits;							// clear control bits
 	ZvgIO.ecpDcrState ^= DCR_InvMask & bits;			// invert them if needed
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState); 			// set new control line values
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState); 				// set new control line values
 }
 
 /*****************************************************************************
@@ -190,7 +232,7 @@ static void scdcr( uchar setBits, uchar clearBits)
 	// invert them if needed
 
 	ZvgIO.ecpDcrState ^= DCR_InvMask & (setBits | clearBits);
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState);	// set new control line values
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState);			// set new control line values
 }
 
 /*****************************************************************************
@@ -199,7 +241,7 @@ static void scdcr( uchar setBits, uchar clearBits)
 static void wdcr( uchar bits)
 {
 	ZvgIO.ecpDcrState = bits ^ DCR_InvMask;
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState);
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState);
 }
 
 /*****************************************************************************
@@ -207,7 +249,7 @@ static void wdcr( uchar bits)
 *****************************************************************************/
 static uchar rdsr( void)
 {
-	return (inportb( ZvgIO.ecpDsr) ^ DSR_InvMask);
+	return (ZvgIO.ops->rdsr() ^ DSR_InvMask);
 } 
 
 /*****************************************************************************
@@ -240,10 +282,10 @@ static uint negotiate_1284( uchar mode)
 {
 	// Setup a negotiation request, setup for at least 1us
 
-	outportb( ZvgIO.ecpData, mode);					// setup data lines
-	outportb( ZvgIO.ecpData, mode);
-	outportb( ZvgIO.ecpData, mode);
-	outportb( ZvgIO.ecpData, mode);
+	ZvgIO.ops->wdata( mode);					// setup data lines
+	ZvgIO.ops->wdata( mode);
+	ZvgIO.ops->wdata( mode);
+	ZvgIO.ops->wdata( mode);
 
 	// Set 1284_Active high and HostBusy low
 
@@ -258,9 +300,9 @@ static uint negotiate_1284( uchar mode)
 	// set HostClk low for 1us
 
 	cdcr( DCR_HostClk);
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState);
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState);
-	outportb( ZvgIO.ecpDcr, ZvgIO.ecpDcrState);
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState);
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState);
+	ZvgIO.ops->wdcr( ZvgIO.ecpDcrState);
 
 	// finish pulse and set HostBusy high
 
@@ -291,7 +333,7 @@ static uint terminate_1284( void)
 
 	// set port back to SPP mode
 
-	outportb( ZvgIO.ecpEcr, ECR_SPP_mode | ECR_nErrIntrEn | ECR_serviceIntr);
+	ZvgIO.ops->ecpMode( zFalse);
 
 	// release 1284 active lines
 
@@ -434,10 +476,13 @@ static uint isDataAvail( void)
 /*****************************************************************************
 * Look for the 'ZVGPORT=' environment variable and parse it.
 *
+* 'Pxxx' gives a port address (hex) to use with port I/O, 'Nx' the number
+* of a /dev/parport device to use through ppdev instead.
+*
 * Returns:
 *    errCode
 *****************************************************************************/
-uint zvgEnv( uint *portAdr, uint *monitor)
+uint zvgEnv( uint *portAdr, uint *parport, uint *monitor)
 {
 	char	*env, *envP, cmd;
 
@@ -471,6 +516,13 @@ uint zvgEnv( uint *portAdr, uint *monitor)
 			*portAdr = strtoul( envP, &envP, 16);	// read port address
 			break;
 
+		case 'N':								// or check for parport 'N'umber
+			if (!isdigit( *envP))
+				return (errEnvPort);			// bad environment parport value
+
+			*parport = strtoul( envP, &envP, 10);		// read parport number
+			break;
+
 		case 'M':								// or check for 'M'onitor type
 			if (!isdigit( *envP))
 				return (errEnvMon);			// bad environment monitor value
@@ -495,7 +547,7 @@ uint zvgEnv( uint *portAdr, uint *monitor)
 uint zvgDetectECP( uint portAdr)
 {
 	uchar		pv, cnfgA, cnfgB;
-	uint		err;
+	uint		err, depth;
 
 	err = errOk;
 
@@ -507,10 +559,12 @@ uint zvgDetectECP( uint portAdr)
 	ZvgIO.ecpDsr = portAdr + ECP_dsr;
 	ZvgIO.ecpEcr = portAdr + ECP_ecr;
 	ZvgIO.ecpEcpDFifo = portAdr + ECP_ecpDFifo;
+	ZvgIO.ops = &ZvgRawOps;
 
 	// Reset all ECP flags
 
 	ZvgIO.ecpFlags = 0;
+	ZvgIO.ecpFifoDepth = 0;
 
 	// Claim port access
 	err = iopl(3);
@@ -560,6 +614,28 @@ uint zvgDetectECP( uint portAdr)
 			err = errEcpWord;
 	}
 
+	// 'cnfgA' only gives the word size, so find the FIFO depth by filling
+	// it in test mode until it reports full. Dropping back to SPP mode
+	// empties it again. If it never fills, leave the depth unknown and
+	// send a byte at a time.
+
+	if (err == errOk)
+	{
+		outportb( ZvgIO.ecpEcr, ECR_SPP_mode | ECR_nErrIntrEn | ECR_serviceIntr);
+		outportb( ZvgIO.ecpEcr, ECR_Test_mode | ECR_nErrIntrEn | ECR_serviceIntr);
+
+		for (depth = 0; depth < ECP_FIFO_MAX; depth++)
+		{
+			if (inportb( ZvgIO.ecpEcr) & ECR_full)
+				break;
+
+			outportb( ZvgIO.ecpEcpDFifo, 0xAA);
+		}
+
+		if (depth < ECP_FIFO_MAX)
+			ZvgIO.ecpFifoDepth = depth;
+	}
+
 	// set port to SPP mode
 
 	outportb( ZvgIO.ecpEcr, ECR_SPP_mode | ECR_nErrIntrEn | ECR_serviceIntr);
@@ -603,24 +679,34 @@ void zvgGetPortInfo( uint *aPORT, uint *aMON)
 uint zvgInit( void)
 {
 	uint				err, ii;
-	uint				envPort, envMode;
+	uint				envPort, envParport, envMode;
 
 	envPort = (uint)-1;				// mark as non-existant
+	envParport = (uint)-1;				// mark as non-existant
 	envMode = (uint)-1;				// mark as non-existant
 
 	ZvgIO.envMonitor = (uint)-1;			// mark as non-existant
 
 	tmrInit();					// initialize timers
-	tmrSetFrameRate(60);				// set the frame rate
+	if (tmrGetTicksInFrame() == 0)
+		tmrSetFrameRate(60);			// set the frame rate, unless it was set before a reopen
 
 	// read the 'ZVGPORT=' environment variable
 
-	err = zvgEnv( &envPort, &ZvgIO.envMonitor);
+	err = zvgEnv( &envPort, &envParport, &ZvgIO.envMonitor);
+
+#ifdef ZVGSIM
+	if (err == errNoEnv)
+		err = errOk;									// nothing to configure for the simulator
+
+	if (envPort == (uint)-1 && envParport == (uint)-1)
+		envPort = ZVGSIM_PORT;
+#endif
 
 	if (err)
 		return (err);
 
-	if (envPort == (uint)-1)
+	if (envPort == (uint)-1 && envParport == (uint)-1)
 		return (errNoPort);						// no port address given, can't continue
 
 	// check for a monitor type, if not, set a default value
@@ -628,7 +714,13 @@ uint zvgInit( void)
 	if (ZvgIO.envMonitor == (uint)-1)
 		ZvgIO.envMonitor = MONF_SPOTKILL;	// handle spotkiller by default
 
-	err = zvgDetectECP( envPort);				// validate ECP port, get chipset DMA and IRQ
+	// a parport device is used in preference to port I/O
+
+	if (envParport != (uint)-1)
+		err = ZvgPpdevOps.open( envParport);
+
+	else
+		err = zvgDetectECP( envPort);			// validate ECP port, get chipset DMA and IRQ
 
 	if (err)
 		return (err);
@@ -641,10 +733,14 @@ uint zvgInit( void)
 	if (ZvgIO.dmaBf1P == 0 || ZvgIO.dmaBf2P == 0)
 		return (errMemory);
 
+	ZvgIO.dmaBf1Size = MEM_BFR_SZ;
+	ZvgIO.dmaBf2Size = MEM_BFR_SZ;
+
 	// reset buffer index / count
 
 	ZvgIO.dmaCurP = ZvgIO.dmaBf1P;
 	ZvgIO.dmaCurCount = 0;
+	ZvgIO.dmaCurSize = MEM_BFR_SZ;
 
 	// attempt to transmit a block of NOPs to the ZVG.
 	// The number of NOPs sent should overflow the ECP buffer, to verify that the ZVG
@@ -674,6 +770,10 @@ uint zvgInit( void)
 *****************************************************************************/
 void zvgClose( void)
 {
+	// finish sending anything queued, and stop the transmit thread
+
+	zvgDmaAsync( zFalse);
+
 	// release memory
 
 	if (ZvgIO.dmaBf1P != 0)
@@ -718,6 +818,13 @@ void zvgClose( void)
 
 		zvgSetSppMode();											// go back to the compatibility mode
 	}
+
+	// let go of the port
+
+	if (ZvgIO.ops != 0)
+	{	ZvgIO.ops->close();
+		ZvgIO.ops = 0;
+	}
 }
 
 /*****************************************************************************
@@ -752,10 +859,10 @@ uint zvgSppPutc( uchar cc)
 
 	// place data on bus, assume at least one cycle per access, wait for at least 1us
 
-	outportb( ZvgIO.ecpData, cc);
-	outportb( ZvgIO.ecpData, cc);
-	outportb( ZvgIO.ecpData, cc);
-	outportb( ZvgIO.ecpData, cc);
+	ZvgIO.ops->wdata( cc);
+	ZvgIO.ops->wdata( cc);
+	ZvgIO.ops->wdata( cc);
+	ZvgIO.ops->wdata( cc);
 
 	cdcr( DCR_nStrobe);			// set strobe low
 
@@ -1019,7 +1126,7 @@ uint zvgSetEcpMode( void)
 
 	// setup the hardware to do automatic ECP mode transfers
 
-	outportb( ZvgIO.ecpEcr, ECR_ECP_mode | ECR_nErrIntrEn | ECR_serviceIntr);
+	ZvgIO.ops->ecpMode( zTrue);
 	sdcr( DCR_HostAck | DCR_HostClk);
 	return (errOk);
 }
@@ -1075,6 +1182,51 @@ uint zvgIsDataAvail( uint aTime)
 	return (errOk);
 }
 
+/*****************************************************************************
+* Wait up to a second for the ECR bits in 'mask' to read as 'bitVal', while
+* the ECP FIFO drains. Every 100ms the status lines are checked in case the
+* peripheral has dropped out of ECP mode.
+*
+* Returns:
+*    errEcpTimeout - If no response.
+*    errEcpToSpp   - If DSR_XFlag line was dropped, also resets ECP to SPP mode.
+*****************************************************************************/
+static uint rawEcpWait( uchar mask, uchar bitVal)
+{
+	uint	ii;
+
+	// wait for 1 second
+
+	for (ii = 0; ii < 10; ii++)
+	{
+		// check every 100ms for a breach in protocol
+
+		if (waitForEcrEQ( mask, bitVal, 100) == ZVG_TIMEOUT)
+		{
+			// if no response after 100ms, do a quick check of the status lines to
+			// see if XFlag or PeriphClk has dropped.
+
+			if ((rdsr() & (DSR_XFlag | DSR_PeriphClk)) != (DSR_XFlag | DSR_PeriphClk))
+			{
+				// The 1284 peripheral is not allowed to drop out of ECP
+				// mode without being requested to do so, and the
+				// the PeriphClk must remain high while in ECP forward transfer
+				// mode, so something unusual has happened, like a cable disconnect.
+
+				compatibility();				// go immediatly into SPP mode
+				return (errEcpToSpp);
+			}
+		}
+		else
+			break;
+	}
+
+	if (ii == 10)
+		return (errEcpTimeout);				// it's taken too long, something wrong
+
+	return (errOk);
+}
+
 /*****************************************************************************
 * Write a byte to the port using ECP mode with hardware assist.
 *
@@ -1087,9 +1239,9 @@ uint zvgIsDataAvail( uint aTime)
 *    errEcpTimeout - If no response.
 *    errEcpToSpp   - If DSR_XFlag line was dropped, also resets ECP to SPP mode.
 *****************************************************************************/
-uint zvgEcpPutc( uchar cc)
+static uint rawEcpPutc( uchar cc)
 {
-	uint	ii;
+	uint	err;
 
 	// for speed, check first if room in ECP buffer
 
@@ -1100,34 +1252,10 @@ uint zvgEcpPutc( uchar cc)
 
 	else
 	{
-		// wait for 1 second
-
-		for (ii = 0; ii < 10; ii++)
-		{
-			// check every 100ms for a breach in protocol
+		err = rawEcpWait( ECR_full, 0);
 
-			if (waitForEcrEQ( ECR_full, 0, 100) == ZVG_TIMEOUT)
-			{
-				// if no response after 100ms, do a quick check of the status lines to
-				// see if XFlag or PeriphClk has dropped.
-
-				if ((rdsr() & (DSR_XFlag | DSR_PeriphClk)) != (DSR_XFlag | DSR_PeriphClk))
-				{
-					// The 1284 peripheral is not allowed to drop out of ECP
-					// mode without being requested to do so, and the
-					// the PeriphClk must remain high while in ECP forward transfer
-					// mode, so something unusual has happened, like a cable disconnect.
-
-					compatibility();				// go immediatly into SPP mode
-					return (errEcpToSpp);
-				}
-			}
-			else
-				break;
-		}
-
-		if (ii == 10)
-			return (errEcpTimeout);				// it's taken too long, something wrong
+		if (err)
+			return (err);
 
 		// if no timeout, send data, hardware takes care of handshaking
 
@@ -1141,29 +1269,134 @@ uint zvgEcpPutc( uchar cc)
 *
 * ECP mode must have already been negotiated.
 *
+* If the FIFO depth is known, ECR is only read again once as many bytes have
+* been written as it said there was room for. An empty FIFO has room for a
+* whole burst of 'ecpFifoDepth' bytes, one that is only part full has room
+* for at least one more, so the FIFO is topped up as it drains and the port
+* is never left idle. When the link keeps up, ECR is read once a burst
+* rather than once a byte. Without a known depth, bytes go one at a time
+* through 'rawEcpPutc()'.
+*
 * Called with:
 *    mem     = Pointer that points to memory block.
 *    memSize = Size of block of data to be sent.
 *****************************************************************************/
-uint zvgEcpPutMem( uchar *mem, uint memSize)
+static uint rawEcpWrite( uchar *mem, uint memSize)
 {
-	uint	err;
+	uint	err, room;
+	uchar	ecr;
 
 	err = errOk;
 
-	while (memSize-- > 0)
+	while (memSize > 0)
 	{
-		err = zvgEcpPutc( *mem);
+		if (ZvgIO.ecpFifoDepth == 0)
+		{
+			err = rawEcpPutc( *mem);					// unknown depth: byte at a time
 
-		if (err)
-			break;
+			if (err)
+				break;
 
-		else
 			mem++;
+			memSize--;
+			continue;
+		}
+
+		ecr = inportb( ZvgIO.ecpEcr);
+
+		if (ecr & ECR_empty)
+			room = ZvgIO.ecpFifoDepth;				// room for a whole burst
+
+		else
+		{
+			// If it's full, do the longer TIMED wait for a free byte
+
+			if (ecr & ECR_full)
+			{
+				err = rawEcpWait( ECR_full, 0);
+
+				if (err)
+					break;
+			}
+			room = 1;
+		}
+
+		if (room > memSize)
+			room = memSize;
+
+		memSize -= room;
+
+		while (room-- > 0)
+			outportb( ZvgIO.ecpEcpDFifo, *mem++);	// send data, let hardware handshake
 	}
 	return (err);
 }
 
+/*****************************************************************************
+* The rest of the port I/O backend.
+*****************************************************************************/
+static void rawClose( void)
+{
+}
+
+static uchar rawRdsr( void)
+{
+	return (inportb( ZvgIO.ecpDsr));
+}
+
+static void rawWdcr( uchar dcr)
+{
+	outportb( ZvgIO.ecpDcr, dcr);
+}
+
+static void rawWdata( uchar cc)
+{
+	outportb( ZvgIO.ecpData, cc);
+}
+
+static void rawEcpMode( bool on)
+{
+	outportb( ZvgIO.ecpEcr, (on ? ECR_ECP_mode : ECR_SPP_mode) | ECR_nErrIntrEn | ECR_serviceIntr);
+}
+
+const ZvgPortOps_s	ZvgRawOps =
+{	zvgDetectECP,
+	rawClose,
+	rawRdsr,
+	rawWdcr,
+	rawWdata,
+	rawEcpMode,
+	rawEcpWrite
+};
+
+/*****************************************************************************
+* Write a byte to the port using ECP mode.
+*
+* ECP mode must have already been negotiated.
+*
+* Returns:
+*    errEcpTimeout - If no response.
+*    errEcpToSpp   - If DSR_XFlag line was dropped, also resets ECP to SPP mode.
+*****************************************************************************/
+uint zvgEcpPutc( uchar cc)
+{
+	return (ZvgIO.ops->ecpWrite( &cc, 1));
+}
+
+/*****************************************************************************
+* Write a block of memory to the port using ECP mode.
+*
+* ECP mode must have already been negotiated.
+*
+* Called with:
+*    mem     = Pointer that points to memory block.
+*    memSize = Size of block of data to be sent.
+*****************************************************************************/
+uint zvgEcpPutMem( uchar *mem, uint memSize)
+{
+	return (ZvgIO.ops->ecpWrite( mem, memSize));
+}
+
 /*****************************************************************************
 * Start a DMA transfer to the ZVG.
 *
@@ -1179,7 +1412,7 @@ uint zvgEcpPutMem( uchar *mem, uint memSize)
 *
 *    Else, returns a ZVG error code.
 *****************************************************************************/
-static uint zvgDmaStart( uchar *mem, uint count)
+static uint zvgDmaXmit( uchar *mem, uint count)
 {
 	uint	err;
 
@@ -1192,21 +1425,222 @@ static uint zvgDmaStart( uchar *mem, uint count)
 			return (err);												// if error, return
 	}
 
-	err = errOk;
+	// send the buffer to the ZVG, a FIFO full at a time
 
-	// loop through buffer sending bytes to the ZVG
+	err = zvgEcpPutMem( mem, count);
 
-	while (!err && count > 0)
-	{	err = zvgEcpPutc( *mem);
-		mem++;
-		count--;
-	}
 	if (err == errEcpTimeout)
 		compatibility();												// if timeout, force compatibility mode
 
 	return (err);
 }
 
+/*****************************************************************************
+* Transmit thread. Sends each buffer handed over by 'zvgDmaStart()'.
+*****************************************************************************/
+static void *zvgDmaThread( void *arg)
+{
+	uint	err;
+
+	(void)arg;
+
+	pthread_mutex_lock( &XmtLock);
+
+	for (;;)
+	{
+		while (XmtRunning && XmtMem == 0)
+			pthread_cond_wait( &XmtCond, &XmtLock);
+
+		if (XmtMem == 0)
+			break;											// stopped, and nothing left to send
+
+		pthread_mutex_unlock( &XmtLock);
+		err = zvgDmaXmit( XmtMem, XmtCount);
+		pthread_mutex_lock( &XmtLock);
+
+		XmtErr = err;
+		XmtMem = 0;
+		pthread_cond_broadcast( &XmtCond);
+	}
+	pthread_mutex_unlock( &XmtLock);
+	return (0);
+}
+
+/*****************************************************************************
+* Wait for the transmit thread to finish the buffer it's sending.
+*
+* Called with:
+*    stall = If set, count the wait as a stall.
+*
+* Returns:
+*    The error from the last buffer sent.
+*****************************************************************************/
+static uint zvgDmaWait( bool stall)
+{
+	uint				err;
+	long long int	timer;
+
+	if (!XmtRunning)
+		return (errOk);
+
+	pthread_mutex_lock( &XmtLock);
+
+	if (XmtMem != 0)
+	{	timer = tmrReadTimer();
+
+		while (XmtMem != 0)
+			pthread_cond_wait( &XmtCond, &XmtLock);
+
+		if (stall)
+		{	XmtStalls++;
+			XmtStallTime += tmrReadTimer() - timer;
+		}
+	}
+	err = XmtErr;
+	XmtErr = errOk;
+
+	pthread_mutex_unlock( &XmtLock);
+	return (err);
+}
+
+/*****************************************************************************
+* Start sending a buffer to the ZVG.
+*
+* If the transmit thread is running, this waits for the previous buffer to
+* finish, then hands over this one and returns without waiting for it. Any
+* error sending a buffer is returned by the next call.
+*
+* Returns:
+*    errOk         - if send started.
+*    errEcpTimeout - if timeout while waiting for ZVG.
+*
+*    Else, returns a ZVG error code.
+*****************************************************************************/
+static uint zvgDmaStart( uchar *mem, uint count)
+{
+	uint	err;
+
+	if (!XmtRunning)
+		return (zvgDmaXmit( mem, count));
+
+	err = zvgDmaWait( zTrue);
+
+	if (err)
+		return (err);
+
+	pthread_mutex_lock( &XmtLock);
+	XmtMem = mem;
+	XmtCount = count;
+	pthread_cond_broadcast( &XmtCond);
+	pthread_mutex_unlock( &XmtLock);
+
+	return (errOk);
+}
+
+/*****************************************************************************
+* Start or stop the transmit thread.
+*
+* Nothing else may talk to the port while the thread runs, so it should be
+* started once the ZVG has been set up, and stopped before anything but
+* frames is sent. If the thread cannot be started, buffers are sent
+* as before, before 'zvgDmaStart()' returns.
+*
+* Called with:
+*    enable = zTrue to start the thread, zFalse to stop it.
+*
+* Returns:
+*    The error from the last buffer sent, if stopping.
+*****************************************************************************/
+uint zvgDmaAsync( bool enable)
+{
+	uint	err;
+
+	if (enable)
+	{
+		if (!XmtRunning)
+		{	XmtMem = 0;
+			XmtErr = errOk;
+			XmtStalls = 0;
+			XmtStallTime = 0;
+			XmtRunning = zTrue;									// set first, the thread quits if it isn't
+
+			if (pthread_create( &XmtThread, 0, zvgDmaThread, 0) != 0)
+				XmtRunning = zFalse;
+		}
+		return (errOk);
+	}
+
+	if (!XmtRunning)
+		return (errOk);
+
+	pthread_mutex_lock( &XmtLock);
+	XmtRunning = zFalse;									// thread sends what it has, then quits
+	pthread_cond_broadcast( &XmtCond);
+	pthread_mutex_unlock( &XmtLock);
+
+	pthread_join( XmtThread, 0);
+
+	err = XmtErr;
+	XmtErr = errOk;
+	return (err);
+}
+
+/*****************************************************************************
+* Return the number of frames that had to wait for the previous frame to
+* finish sending, and the total time spent waiting in milliseconds.
+*****************************************************************************/
+void zvgDmaStallStats( uint *frames, uint *ms)
+{
+	*frames = XmtStalls;
+	*ms = (uint)(XmtStallTime / 1000000);
+}
+
+/*****************************************************************************
+* Make sure there is room for 'len' more bytes in the current DMA buffer.
+*
+* The buffer is doubled in size until the bytes fit, but is never grown
+* past MEM_BFR_MAX. The other buffer keeps its own size, and catches up the
+* first time a frame built in it needs the room.
+*
+* Returns:
+*    errOk       - No error.
+*    errBfrFull  - If the bytes will not fit.
+*****************************************************************************/
+uint zvgDmaReserve( uint len)
+{
+	uchar	*newP;
+	uint	newSize;
+
+	if ((ZvgIO.dmaCurCount + len) <= ZvgIO.dmaCurSize)
+		return (errOk);
+
+	if ((ZvgIO.dmaCurCount + len) > MEM_BFR_MAX)
+		return (errBfrFull);
+
+	newSize = ZvgIO.dmaCurSize;
+
+	while (newSize < (ZvgIO.dmaCurCount + len))
+		newSize *= 2;
+
+	newP = (uchar*)(realloc( ZvgIO.dmaCurP, newSize));
+
+	if (newP == 0)
+		return (errBfrFull);
+
+	if (ZvgIO.dmaCurP == ZvgIO.dmaBf1P)
+	{	ZvgIO.dmaBf1P = newP;
+		ZvgIO.dmaBf1Size = newSize;
+	}
+	else
+	{	ZvgIO.dmaBf2P = newP;
+		ZvgIO.dmaBf2Size = newSize;
+	}
+	ZvgIO.dmaCurP = newP;
+	ZvgIO.dmaCurSize = newSize;
+
+	return (errOk);
+}
+
 /*****************************************************************************
 * Write a byte to the port using a buffered DMA mode.
 *
@@ -1218,19 +1652,20 @@ static uint zvgDmaStart( uchar *mem, uint count)
 *****************************************************************************/
 uint zvgDmaPutc( uchar cc)
 {
-	if (ZvgIO.dmaCurCount < MEM_BFR_SZ )
-		ZvgIO.dmaCurP[ZvgIO.dmaCurCount++] = cc;
-
-	else
+	if (zvgDmaReserve( 1))
 		return (errBfrFull);
 
+	ZvgIO.dmaCurP[ZvgIO.dmaCurCount++] = cc;
+
 	return (errOk);
 }
 
 /*****************************************************************************
 * Write a block of memory to the port using a buffered DMA mode.
 *
-* Memory block is added to a DMA buffer to be sent later.
+* Memory block is added to a DMA buffer to be sent later. A block that will
+* not fit is dropped whole, since a partial ZVG command would upset the
+* rest of the frame.
 *
 * Returns:
 *    errOk       - No error.
@@ -1238,17 +1673,12 @@ uint zvgDmaPutc( uchar cc)
 *****************************************************************************/
 uint zvgDmaPutMem( uchar *mem, uint len)
 {
-	if (ZvgIO.dmaCurCount < MEM_BFR_SZ)
-	{
-		if ((ZvgIO.dmaCurCount + len) > MEM_BFR_SZ)
-			len = MEM_BFR_SZ - ZvgIO.dmaCurCount;
-
-		memcpy( &ZvgIO.dmaCurP[ZvgIO.dmaCurCount], mem, len);
-		ZvgIO.dmaCurCount += len;
-	}
-	else
+	if (zvgDmaReserve( len))
 		return (errBfrFull);
 
+	memcpy( &ZvgIO.dmaCurP[ZvgIO.dmaCurCount], mem, len);
+	ZvgIO.dmaCurCount += len;
+
 	return (errOk);
 }
 
@@ -1269,7 +1699,16 @@ void zvgDmaClearBfr( void)
 *****************************************************************************/
 uint zvgDmaSend( void)
 {
-	return (zvgDmaStart( ZvgIO.dmaCurP, ZvgIO.dmaCurCount));
+	uint	err;
+
+	err = zvgDmaStart( ZvgIO.dmaCurP, ZvgIO.dmaCurCount);
+
+	// the current buffer is about to be added to, so it must be sent first
+
+	if (!err)
+		err = zvgDmaWait( zFalse);
+
+	return (err);
 }
 
 /*****************************************************************************
@@ -1292,10 +1731,12 @@ uint zvgDmaSendSwap( void)
 		if (ZvgIO.dmaCurP == ZvgIO.dmaBf1P)
 		{	ZvgIO.dmaBf1Count = ZvgIO.dmaCurCount;			// keep track of count for possible resend
 			ZvgIO.dmaCurP = ZvgIO.dmaBf2P;					// point to 2nd buffer
+			ZvgIO.dmaCurSize = ZvgIO.dmaBf2Size;
 		}
 		else
 		{	ZvgIO.dmaBf2Count = ZvgIO.dmaCurCount;			// keep track of count for possible resend
 			ZvgIO.dmaCurP = ZvgIO.dmaBf1P;					// point to 1st buffer
+			ZvgIO.dmaCurSize = ZvgIO.dmaBf1Size;
 		}
 		ZvgIO.dmaCurCount = 0;								// clear buffer
 	}
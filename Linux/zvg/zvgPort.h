@@ -8,6 +8,13 @@
 * Last Updated: 05/21/03
 *
 * History:
+*    10/16/26
+*       With ZVGSIM defined, port I/O goes to the simulated port and ZVG
+*       in zvgSim.c.
+*
+*    10/16/26
+*       Added 'ZvgPortOps_s', so the port can be driven by port I/O or
+*       through the kernel's ppdev driver.
 *
 * (c) Copyright 2002-2004, Zektor, LLC.  All Rights Reserved.
 *****************************************************************************/
@@ -45,6 +52,7 @@ extern "C" {
 #define	ECR_EPP_mode			0x20		// Bi-Di mode
 #define	ECR_FSPP_mode			0x40		// Fast SPP mode
 #define	ECR_ECP_mode			0x60		// ECP mode
+#define	ECR_Test_mode			0xC0		// FIFO test mode, used to find the FIFO depth
 #define	ECR_Cnfg_mode			0xE0		// Confige mode, makes 'cnfgA' and 'cnfgB' available
 
 #define	ECR_nErrIntrEn			0x10
@@ -55,6 +63,8 @@ extern "C" {
 
 #define	CFGB_compress			0x80		// if set, use ECP compression
 
+#define	ECP_FIFO_MAX			1024		// give up measuring the FIFO past this depth
+
 // DSR Bitmaps
 
 #define	DSR_InvMask				(DSR_Busy)
@@ -153,7 +163,8 @@ enum portErrCode
 	errZvgRomTI,				// flash timeout during write
 	errUnknownID,				// unknown ID string returned from request ID
 	errNotRoot,				// Linux requires port driver to run as root
-	errIOPL					// Handle IOPL error rather than returning bogus "1" error code
+	errIOPL,				// Handle IOPL error rather than returning bogus "1" error code
+	errPpdev				// Could not open or claim the /dev/parport device
 };
 // This structure reflects the structure inside the ZVG firmware. Note that DJGPP does not
 // pack structures by default, but the data inside the ZVG is packed.
@@ -202,6 +213,20 @@ typedef struct ZVGID_S
 	uint	vESB;						// vtg error status bits
 } ZvgID_s;
 
+// Port access. The 1284 negotiation and NIBBLE mode code drives the lines
+// through these, only forward ECP transfers are left to the backend.
+// Register values are raw, as read from or written to the port.
+
+typedef struct ZVGPORTOPS_S
+{	uint		(*open)( uint port);				// claim the port, leave it in SPP mode
+	void		(*close)( void);					// release the port
+	uchar		(*rdsr)( void);					// read the DSR
+	void		(*wdcr)( uchar dcr);				// write the DCR
+	void		(*wdata)( uchar cc);				// write the data lines
+	void		(*ecpMode)( bool on);			// switch to or from ECP forward transfers
+	uint		(*ecpWrite)( uchar *mem, uint len);	// send data in ECP forward mode
+} ZvgPortOps_s;
+
 typedef struct ZVGIO_S
 {
 	// These are initialized by caller's arguments
@@ -225,17 +250,23 @@ typedef struct ZVGIO_S
 	uchar		ecpDcrState;			// Current state of the DCR register
 
 	uint		ecpFlags;				// Flags to keep track of various ECP states
+	uint		ecpFifoDepth;			// Bytes the ECP FIFO holds, 0 if unknown
+
+	const ZvgPortOps_s	*ops;			// Port access backend
 
 	// DMA variables
 
 	uchar		*dmaBf1P;				// Pointer to 1st buffer
 	uint		dmaBf1Count;			// Count of data in 1st buffer
+	uint		dmaBf1Size;				// Allocated size of 1st buffer
 
 	uchar		*dmaBf2P;				// Pointer to 2nd buffer
 	uint		dmaBf2Count;			// Count of data in 2nd DMA buffer
+	uint		dmaBf2Size;				// Allocated size of 2nd buffer
 
 	uchar		*dmaCurP;				// Pointer to current buffer
 	uint		dmaCurCount;			// Count of characters in current DMA buffer
+	uint		dmaCurSize;				// Allocated size of current DMA buffer
 
 	// Miscellaneous buffer used to communicate with the ZVG
 
@@ -260,6 +291,7 @@ typedef struct ZVGIO_S
 // Defines moved up from zvPort.c
 #define	DMA_BFR_SZ	8			// the size of a single DMA buffer (in K)
 #define	MEM_BFR_SZ	(32768)		// explicit buffer size
+#define	MEM_BFR_MAX	(MEM_BFR_SZ*32)	// buffers double in size as needed, up to this
 #define	LO( nn)		((nn) & 0xFF)
 #define	HI( nn)		((nn) >> 8)
 
@@ -267,6 +299,9 @@ typedef struct ZVGIO_S
 
 extern ZvgIO_s	ZvgIO;					// Structure used to communicate with ZVG
 
+extern const ZvgPortOps_s	ZvgRawOps;		// port I/O, needs root (zvgPort.c)
+extern const ZvgPortOps_s	ZvgPpdevOps;	// /dev/parportN (zvgPpdev.c)
+
 extern void zvgBanner( ZvgSpeeds_a speeds, ZvgID_s *id);
 extern void zvgError( uint err);
 extern uint zvgInit( void);
@@ -297,12 +332,50 @@ extern uint zvgDmaSendSwap( void);
 extern uint zvgDmaSendPrev( void);
 extern uint zvgDmaPutc( uchar cc);
 extern uint zvgDmaPutMem( uchar *mem, uint len);
+extern uint zvgDmaReserve( uint len);
 extern void zvgDmaClearBfr( void);
+extern uint zvgDmaAsync( bool enable);
+extern void zvgDmaStallStats( uint *frames, uint *ms);
+
+#ifdef ZVGSIM
+
+// Totals received by the simulated ZVG (zvgSim.c)
+
+typedef struct ZVGSIMSTATS_S
+{	uint	bytes;					// bytes received in ECP mode
+	uint	frames;					// CENTER commands, one at the end of each frame
+	uint	vectors;					// vector commands
+	uint	points;					// point (and beam move) commands
+	uint	absolutes;				// commands that gave a starting X/Y
+	uint	colors;					// commands that gave a color
+	uint	nops;						// NOP commands
+	uint	others;					// other extended commands
+	uint	lost;						// bytes sent when the ZVG wasn't listening
+} ZvgSimStats_s;
+
+extern uchar zvgSimIn( uint port);
+extern void zvgSimOut( uint port, uchar cc);
+extern void zvgSimSetRate( uint rate);
+extern uint zvgSimCapture( const char *file);
+extern void zvgSimStats( ZvgSimStats_s *stats);
+extern void zvgSimReport( void);
+
+// Port I/O goes to the simulated port, which needs no privileges
+
+#define	ZVGSIM_PORT		0x378			// port address used if ZVGPORT isn't set
+
+#define inportb(PortAddress)		zvgSimIn(PortAddress)
+#define outportb(PortAddress,Data)	zvgSimOut(PortAddress,Data)
+#define iopl(level)					(0)
+
+#else
 
 // Linux Port Macros , using sys/io.h
 #define inportb(PortAddress)		inb(PortAddress)
 #define outportb(PortAddress,Data)	outb(Data,PortAddress)
 
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,194 @@
+/*****************************************************************************
+* ZVG port access through the Linux ppdev driver (/dev/parportN).
+*
+* Unlike port I/O this needs no root or 'iopl()', only write access to the
+* device. The 1284 negotiation and NIBBLE mode code in zvgPort.c works the
+* lines through the PPRSTATUS, PPWCONTROL and PPWDATA ioctls just as it
+* does with port I/O. Once ECP mode has been negotiated, the kernel is told
+* the mode and phase, and forward transfers are plain 'write()' calls, so
+* the kernel's parport driver looks after the ECP FIFO.
+*
+* Created: 10/16/26
+*
+* History:
+*
+*****************************************************************************/
+#include	<stdio.h>
+#include	<errno.h>
+#include	<fcntl.h>
+#include	<unistd.h>
+#include	<sys/ioctl.h>
+#include	<sys/time.h>
+#include	<linux/parport.h>
+#include	<linux/ppdev.h>
+
+#include	"zstddef.h"
+#include	"zvgPort.h"
+
+// The kernel's IEEE1284_PH_FWD_IDLE, which isn't in the user space headers
+
+#define	PP_PH_FWD_IDLE		1
+
+// Time the kernel waits for the ZVG before a write gives up, the same
+// second 'zvgEcpPutc()' allows with port I/O
+
+#define	PP_TIMEOUT_US		1000000
+
+static int	PpFd = -1;						// handle of the open /dev/parport device
+
+/*****************************************************************************
+* Let go of the port.
+*****************************************************************************/
+static void ppClose( void)
+{
+	if (PpFd >= 0)
+	{	ioctl( PpFd, PPRELEASE);
+		close( PpFd);
+		PpFd = -1;
+	}
+}
+
+/*****************************************************************************
+* Open and claim /dev/parport'port'.
+*
+* Returns:
+*    errOk    - Port claimed, in SPP (compatibility) mode.
+*    errPpdev - Could not open or claim the device.
+*****************************************************************************/
+static uint ppOpen( uint port)
+{
+	char				name[32];
+	int				mode, dir;
+	struct timeval	tv;
+
+	ZvgIO.ops = &ZvgPpdevOps;
+	ZvgIO.ecpPort = port;
+	ZvgIO.ecpFlags = 0;
+	ZvgIO.ecpFifoDepth = 0;						// the kernel looks after the FIFO
+
+	sprintf( name, "/dev/parport%u", port);
+
+	PpFd = open( name, O_RDWR);
+
+	if (PpFd < 0)
+		return (errPpdev);
+
+	if (ioctl( PpFd, PPCLAIM) < 0)
+	{	close( PpFd);
+		PpFd = -1;
+		return (errPpdev);
+	}
+
+	// start off in compatibility mode, driving the data lines
+
+	mode = IEEE1284_MODE_COMPAT;
+	dir = 0;
+	tv.tv_sec = PP_TIMEOUT_US / 1000000;
+	tv.tv_usec = PP_TIMEOUT_US % 1000000;
+
+	if (ioctl( PpFd, PPSETMODE, &mode) < 0 || ioctl( PpFd, PPDATADIR, &dir) < 0)
+	{	ppClose();
+		return (errPpdev);
+	}
+	ioctl( PpFd, PPSETTIME, &tv);
+
+	// Set the flags to compatibility mode:
+	//
+	//    nSelectIn - Low
+	//    nAutoFeed - High
+	//    nStrobe   - High
+	//    nInit     - High
+
+	ZvgIO.ecpDcrState = (DCR_nAutoFeed | DCR_nStrobe | DCR_nInit) ^ DCR_InvMask;
+	ioctl( PpFd, PPWCONTROL, &ZvgIO.ecpDcrState);
+
+	return (errOk);
+}
+
+/*****************************************************************************
+* Read the DSR.
+*****************************************************************************/
+static uchar ppRdsr( void)
+{
+	uchar	dsr;
+
+	if (ioctl( PpFd, PPRSTATUS, &dsr) < 0)
+		dsr = 0;
+
+	return (dsr);
+}
+
+/*****************************************************************************
+* Write the DCR.
+*****************************************************************************/
+static void ppWdcr( uchar dcr)
+{
+	ioctl( PpFd, PPWCONTROL, &dcr);
+}
+
+/*****************************************************************************
+* Write the data lines.
+*****************************************************************************/
+static void ppWdata( uchar cc)
+{
+	ioctl( PpFd, PPWDATA, &cc);
+}
+
+/*****************************************************************************
+* Tell the kernel ECP mode has been negotiated, and we're ready to send, or
+* that we're back in compatibility mode.
+*****************************************************************************/
+static void ppEcpMode( bool on)
+{
+	int	mode, phase;
+
+	mode = on ? IEEE1284_MODE_ECP : IEEE1284_MODE_COMPAT;
+	ioctl( PpFd, PPSETMODE, &mode);
+
+	if (on)
+	{	phase = PP_PH_FWD_IDLE;
+		ioctl( PpFd, PPSETPHASE, &phase);
+	}
+}
+
+/*****************************************************************************
+* Send a block of data in ECP forward mode.
+*
+* The kernel writes as much as it can before timing out, so a short write
+* that makes no progress is a timeout. A dropped XFlag can't be told apart
+* from a timeout here, so 'errEcpToSpp' is never returned.
+*
+* Returns:
+*    errOk         - All data sent.
+*    errEcpTimeout - If the ZVG stopped taking data.
+*****************************************************************************/
+static uint ppEcpWrite( uchar *mem, uint len)
+{
+	ssize_t	nn;
+
+	while (len > 0)
+	{
+		nn = write( PpFd, mem, len);
+
+		if (nn <= 0)
+		{
+			if (nn < 0 && errno == EINTR)
+				continue;
+
+			return (errEcpTimeout);
+		}
+		mem += nn;
+		len -= nn;
+	}
+	return (errOk);
+}
+
+const ZvgPortOps_s	ZvgPpdevOps =
+{	ppOpen,
+	ppClose,
+	ppRdsr,
+	ppWdcr,
+	ppWdata,
+	ppEcpMode,
+	ppEcpWrite
+};
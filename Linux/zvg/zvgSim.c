@@ -0,0 +1,593 @@
+/*****************************************************************************
+* Simulated ECP parallel port with a ZVG on the end of it.
+*
+* Built in place of port I/O when ZVGSIM is defined, see 'zvgPort.h'. The
+* 'inportb()' and 'outportb()' calls in zvgPort.c land here, so the whole
+* port I/O path, ECR and FIFO handling included, is exercised without the
+* hardware. Nothing else in the driver knows the port isn't real.
+*
+* The port model covers the data, DSR, DCR, ECR, cnfgA and cnfgB registers
+* and a 16 byte FIFO. In ECP mode the FIFO empties into the ZVG at the rate
+* set with 'zvgSimSetRate()', or at once if no rate is set. Leaving ECP
+* mode throws away anything still in the FIFO, as a real port does.
+*
+* The ZVG end answers 1284 negotiation for the NIBBLE, REQ ID NIBBLE and ECP
+* modes, returns a device ID, and replies to zcREAD_MON and zcREAD_SPD once
+* eight more bytes have arrived behind them, as the firmware's look ahead
+* buffer does. Everything received in ECP mode is decoded as ZVG commands
+* and counted, see 'zvgSimStats()', and can be saved to a file with
+* 'zvgSimCapture()'.
+*
+* Created: 10/16/26
+*
+* History:
+*
+*****************************************************************************/
+#include	<stdio.h>
+#include	<string.h>
+#include	<time.h>
+
+#include	"zstddef.h"
+#include	"zvgCmds.h"
+#include	"zvgPort.h"
+
+#define	SIM_FIFO_DEPTH		16			// bytes in the simulated ECP FIFO
+#define	SIM_LOOK_AHEAD		8			// bytes needed behind a command before the ZVG runs it
+
+// Lines as the peripheral sees them, 'DCR_...' bits with 'DCR_InvMask' undone
+
+#define	SIM_DCR_INIT		(DCR_nAutoFeed | DCR_nStrobe | DCR_nInit)
+
+// DSR lines in the compatibility mode: not busy, no ACK, selected, no fault
+
+#define	SIM_DSR_COMPAT		(DSR_nAck | DSR_Select | DSR_nFault)
+
+// 1284 peripheral states
+
+enum simState
+{	simCompat = 0,				// compatibility (SPP) mode
+	simNegotiate,				// 1284_Active raised, waiting for the HostClk pulse
+	simEcpSetup,				// ECP accepted, waiting for HostAck to go low
+	simEcp,						// ECP forward transfers
+	simNibble,					// reverse NIBBLE transfers
+	simTerminate				// 1284_Active dropped, waiting for HostBusy to go low
+};
+
+// Device ID as sent by the ZVG, the length word is added when it's sent
+
+static const char	SimID[] =
+	"MFG:Zektor;\r\nCMD:ZVG;\r\nMDL:ZVG Simulator;\r\nVER:2810,0810,1010;\r\nSWS:00;\r\nESB:0000,0000;";
+
+// Monitor settings returned for zcREAD_MON, the checksum is added when it's sent
+
+static const uchar	SimMon[ZVG_MON_SIZE-2] = { 0x40, 0x04, 0x08, 0x10, 0x05, 0x00, 0xFF, 0x80, 0x00 };
+
+// Speed table returned for zcREAD_SPD, in us per inch
+
+static const uchar	SimSpeeds[4] = { 15, 20, 25, 30 };
+
+// Port registers
+
+static uchar	SimData;						// data lines
+static uchar	SimDcr = SIM_DCR_INIT ^ DCR_InvMask;	// DCR, as written
+static uchar	SimDsr = SIM_DSR_COMPAT;	// DSR lines, before 'DSR_InvMask' is applied
+static uchar	SimEcr = ECR_nErrIntrEn | ECR_serviceIntr;	// ECR mode and control bits
+static uchar	SimCnfgA = 0x10;			// 8 bit words, writeable
+
+static uchar	SimFifo[SIM_FIFO_DEPTH];
+static uint		SimFifoHead;				// oldest byte in the FIFO
+static uint		SimFifoCount;				// bytes in the FIFO
+
+static uint		SimRate;						// link rate in bytes a second, 0 if instant
+static double	SimCredit;					// bytes the link could have carried so far
+static struct timespec	SimLast;			// time 'SimCredit' was last brought up to date
+
+// The ZVG
+
+static uint		SimState = simCompat;
+static uchar	SimMode;						// extensibility byte from the last negotiation
+static bool		SimStrobed;					// HostClk pulsed during negotiation
+static bool		SimHiNibble;				// next nibble is the high one
+static bool		SimNibbleOut;				// a nibble is on the status lines
+
+static uchar	SimReply[ZVG_MAX_BFRSZ];	// data waiting to be read in NIBBLE mode
+static uint		SimReplyLen;
+static uint		SimReplyPos;
+static uint		SimReplyCmd;				// zcREAD_MON or zcREAD_SPD waiting to run, or 0
+static uint		SimReplyWait;				// bytes still needed before it runs
+
+static uint		SimCmdNeed;					// bytes left in the command being received
+static uchar	SimCmd;						// first byte of that command
+
+static ZvgSimStats_s	SimStats;
+static FILE		*SimCapture;
+
+/*****************************************************************************
+* Number of bytes in the command that starts with 'cmd', see 'zvgEnc.c'.
+*
+* Extended commands (0xE0-0xEF) are single bytes. The set commands among
+* them are never sent by this driver, so their arguments aren't looked for.
+*****************************************************************************/
+static uint simCmdSize( uchar cmd)
+{
+	uint	size;
+
+	if ((cmd & 0xF0) == zcEXTENDED)
+		return (1);
+
+	size = 1;
+
+	if (cmd & zbCOLOR)
+		size += 2;									// 16 bit color
+
+	if (cmd & zbABS)
+	{	size += 3;									// 12 bit X and Y
+
+		if (!(cmd & zbVECTOR))
+			return (size);							// an absolute point has no length
+	}
+
+	if (cmd & zbRATIO)
+		size += (cmd & zbSHORT) ? 2 : 3;		// ratio and 8 or 12 bit length
+
+	else
+		size += (cmd & zbSHORT) ? 1 : 2;		// 8 or 12 bit length
+
+	return (size);
+}
+
+/*****************************************************************************
+* Set the NIBBLE mode status lines to show whether there's data to read.
+*****************************************************************************/
+static void simNibbleIdle( void)
+{
+	SimDsr = DSR_PtrClk;
+
+	if (SimReplyPos >= SimReplyLen)
+		SimDsr |= DSR_AckDataReq | DSR_nDataAvail;	// nothing to send
+}
+
+/*****************************************************************************
+* Load a reply, to be read back in NIBBLE mode.
+*****************************************************************************/
+static void simSetReply( const uchar *data, uint len)
+{
+	memcpy( SimReply, data, len);
+	SimReplyLen = len;
+	SimReplyPos = 0;
+	SimHiNibble = zFalse;
+}
+
+/*****************************************************************************
+* Run a zcREAD_MON or zcREAD_SPD command, and signal the host that there's
+* data waiting by pulling nPeriphRequest low.
+*****************************************************************************/
+static void simRunReply( void)
+{
+	uchar	mon[ZVG_MON_SIZE];
+	uint	ii, sum1, sum2;
+
+	if (SimReplyCmd == zcREAD_MON)
+	{	memcpy( mon, SimMon, sizeof( SimMon));
+
+		// Fletcher's check digits, LSB first
+
+		sum1 = sum2 = 0;
+
+		for (ii = 0; ii < sizeof( SimMon); ii++)
+		{	sum1 = (sum1 + SimMon[ii]) % 255;
+			sum2 = (sum2 + sum1) % 255;
+		}
+		mon[ZVG_MON_SIZE-2] = (uchar)sum1;
+		mon[ZVG_MON_SIZE-1] = (uchar)sum2;
+
+		simSetReply( mon, ZVG_MON_SIZE);
+	}
+	else
+		simSetReply( SimSpeeds, sizeof( SimSpeeds));
+
+	SimReplyCmd = 0;
+
+	if (SimState == simEcp)
+		SimDsr &= ~DSR_nPeriphRequest;
+}
+
+/*****************************************************************************
+* Take a byte from the ECP link, decode and count the ZVG commands.
+*****************************************************************************/
+static void simReceive( uchar cc)
+{
+	if (SimState != simEcp)
+	{	SimStats.lost++;							// nobody listening
+		return;
+	}
+
+	SimStats.bytes++;
+
+	if (SimCapture != 0)
+		fputc( cc, SimCapture);
+
+	// a reply command runs once the look ahead buffer has filled behind it
+
+	if (SimReplyCmd != 0 && --SimReplyWait == 0)
+		simRunReply();
+
+	// carry on with a command already started
+
+	if (SimCmdNeed > 0)
+	{	if (--SimCmdNeed > 0)
+			return;
+	}
+	else
+	{	SimCmd = cc;
+		SimCmdNeed = simCmdSize( cc) - 1;
+
+		if (SimCmdNeed > 0)
+			return;
+	}
+
+	// a whole command has arrived
+
+	if ((SimCmd & 0xF0) == zcEXTENDED)
+	{
+		switch (SimCmd)
+		{
+		case zcNOP:
+			SimStats.nops++;
+			break;
+
+		case zcCENTER:
+			SimStats.frames++;					// sent at the end of every frame
+			break;
+
+		case zcREAD_MON:
+		case zcREAD_SPD:
+			SimReplyCmd = SimCmd;
+			SimReplyWait = SIM_LOOK_AHEAD;
+			SimStats.others++;
+			break;
+
+		default:
+			SimStats.others++;
+			break;
+		}
+		return;
+	}
+
+	if (SimCmd & zbVECTOR)
+		SimStats.vectors++;
+	else
+		SimStats.points++;
+
+	if (SimCmd & zbABS)
+		SimStats.absolutes++;
+
+	if (SimCmd & zbCOLOR)
+		SimStats.colors++;
+}
+
+/*****************************************************************************
+* Empty the FIFO into the ZVG as fast as the link allows. Called each time
+* the host looks at the port, so the FIFO drains while it polls.
+*****************************************************************************/
+static void simDrain( void)
+{
+	struct timespec	now;
+	uint	count;
+
+	if ((SimEcr & 0xE0) != ECR_ECP_mode)
+		return;
+
+	count = SimFifoCount;
+
+	if (SimRate != 0)
+	{	clock_gettime( CLOCK_MONOTONIC, &now);
+
+		if (count == 0)
+			SimCredit = 0;							// an idle link saves nothing up
+
+		else
+		{	SimCredit += ((now.tv_sec - SimLast.tv_sec) + (now.tv_nsec - SimLast.tv_nsec) / 1e9) * SimRate;
+
+			if (SimCredit < count)
+				count = (uint)SimCredit;
+
+			SimCredit -= count;
+		}
+		SimLast = now;
+	}
+
+	while (count-- > 0)
+	{	simReceive( SimFifo[SimFifoHead]);
+		SimFifoHead = (SimFifoHead + 1) % SIM_FIFO_DEPTH;
+		SimFifoCount--;
+	}
+}
+
+/*****************************************************************************
+* React to the host changing the control lines.
+*****************************************************************************/
+static void simControl( uchar dcr)
+{
+	uchar	was, now, rise, fall;
+	uint	nib;
+
+	was = SimDcr ^ DCR_InvMask;
+	now = dcr ^ DCR_InvMask;
+	rise = now & ~was;
+	fall = was & ~now;
+	SimDcr = dcr;
+
+	// 1284_Active dropping ends any mode, a half read reply is thrown away
+
+	if ((fall & DCR_1284_Active) && SimState != simCompat)
+	{	if (SimState == simNibble)
+			SimReplyLen = SimReplyPos = 0;
+
+		SimDsr &= ~DSR_PtrClk;
+		SimDsr ^= DSR_XFlag;
+		SimState = simTerminate;
+		return;
+	}
+
+	switch (SimState)
+	{
+	case simCompat:
+		if (rise & DCR_1284_Active)
+		{	SimMode = SimData;					// negotiation request
+			SimStrobed = zFalse;
+			SimDsr = DSR_AckDataReq | DSR_nDataAvail | DSR_XFlag;
+			SimState = simNegotiate;
+		}
+
+		// SPP data is taken, but the ZVG only listens in ECP mode
+
+		else if (fall & DCR_nStrobe)
+		{	SimDsr |= DSR_Busy;
+			SimStats.lost++;
+		}
+		else if (rise & DCR_nStrobe)
+			SimDsr &= ~DSR_Busy;
+		break;
+
+	case simNegotiate:
+		if (fall & DCR_HostClk)
+			SimStrobed = zTrue;
+
+		if (SimStrobed && (rise & DCR_HostBusy))
+		{
+			if (SimMode == EMODE_ECP)
+			{	SimDsr = DSR_PtrClk | DSR_AckDataReq | DSR_nDataAvail | DSR_XFlag;
+				SimState = simEcpSetup;
+			}
+			else
+			{	// NIBBLE mode, or anything else which then has nothing to send
+
+				if (SimMode == EMODE_REQID_NIBBLE)
+				{	SimReply[0] = HI( sizeof( SimID) + 1);
+					SimReply[1] = LO( sizeof( SimID) + 1);
+					memcpy( SimReply + 2, SimID, sizeof( SimID) - 1);
+					SimReplyLen = sizeof( SimID) + 1;
+					SimReplyPos = 0;
+					SimHiNibble = zFalse;
+				}
+				else if (SimMode != EMODE_NIBBLE)
+					SimReplyLen = SimReplyPos = 0;
+
+				SimNibbleOut = zFalse;
+				simNibbleIdle();
+				SimState = simNibble;
+			}
+		}
+		break;
+
+	case simEcpSetup:
+		if (fall & DCR_HostAck)
+		{	SimDsr = DSR_PeriphClk | DSR_nAckReverse | DSR_XFlag | DSR_nPeriphRequest;
+
+			if (SimReplyCmd == 0 && SimReplyPos < SimReplyLen)
+				SimDsr &= ~DSR_nPeriphRequest;	// a reply is still waiting
+
+			SimCmdNeed = 0;
+			SimState = simEcp;
+		}
+		break;
+
+	case simNibble:
+		if ((fall & DCR_HostBusy) && SimReplyPos < SimReplyLen)
+		{
+			// put the next nibble on Busy, AckDataReq, XFlag and nDataAvail
+
+			nib = SimReply[SimReplyPos];
+
+			if (SimHiNibble)
+				nib >>= 4;
+
+			SimDsr = ((nib & 0x07) << 3) | ((nib & 0x08) << 4);
+			SimNibbleOut = zTrue;
+		}
+		else if ((rise & DCR_HostBusy) && SimNibbleOut)
+		{	SimNibbleOut = zFalse;
+
+			if (SimHiNibble)
+			{	SimHiNibble = zFalse;
+				SimReplyPos++;
+				simNibbleIdle();
+			}
+			else
+			{	SimHiNibble = zTrue;
+				SimDsr |= DSR_PtrClk;
+			}
+		}
+		break;
+
+	case simTerminate:
+		if (fall & DCR_HostBusy)
+		{	SimDsr = SIM_DSR_COMPAT;
+			SimState = simCompat;
+		}
+		break;
+	}
+}
+
+/*****************************************************************************
+* Read a port register.
+*****************************************************************************/
+uchar zvgSimIn( uint port)
+{
+	uchar	ecr;
+
+	simDrain();
+
+	switch (port - ZvgIO.ecpPort)
+	{
+	case ECP_data:
+		return (SimData);
+
+	case ECP_dsr:
+		return (SimDsr ^ DSR_InvMask);
+
+	case ECP_dcr:
+		return (SimDcr);
+
+	case ECP_cnfgA:
+		if ((SimEcr & 0xE0) == ECR_Cnfg_mode)
+			return (SimCnfgA);
+
+		return (0);
+
+	case ECP_cnfgB:
+		return (0);									// no compression, IRQ or DMA
+
+	case ECP_ecr:
+		ecr = SimEcr & ~(ECR_full | ECR_empty);
+
+		if (SimFifoCount == 0)
+			ecr |= ECR_empty;
+
+		if (SimFifoCount == SIM_FIFO_DEPTH)
+			ecr |= ECR_full;
+
+		return (ecr);
+	}
+	return (0xFF);									// nothing there
+}
+
+/*****************************************************************************
+* Write a port register.
+*****************************************************************************/
+void zvgSimOut( uint port, uchar cc)
+{
+	switch (port - ZvgIO.ecpPort)
+	{
+	case ECP_data:
+		SimData = cc;
+		break;
+
+	case ECP_dcr:
+		simControl( cc);
+		break;
+
+	case ECP_ecpDFifo:
+		if ((SimEcr & 0xE0) == ECR_Cnfg_mode)
+		{	SimCnfgA = cc;
+			break;
+		}
+
+		if ((SimEcr & 0xE0) != ECR_ECP_mode && (SimEcr & 0xE0) != ECR_Test_mode)
+			break;
+
+		if (SimFifoCount == SIM_FIFO_DEPTH)
+		{	SimStats.lost++;						// overrun, the byte goes nowhere
+			break;
+		}
+
+		if (SimFifoCount == 0)
+			clock_gettime( CLOCK_MONOTONIC, &SimLast);	// the link starts from now
+
+		SimFifo[(SimFifoHead + SimFifoCount) % SIM_FIFO_DEPTH] = cc;
+		SimFifoCount++;
+		simDrain();
+		break;
+
+	case ECP_ecr:
+		// dropping to mode 000 or 001 resets the FIFO, so anything not yet
+		// sent in ECP mode is lost
+
+		if ((cc & 0xC0) == 0)
+		{	if ((SimEcr & 0xE0) == ECR_ECP_mode)
+				SimStats.lost += SimFifoCount;
+
+			SimFifoCount = 0;
+		}
+		SimEcr = cc & ~(ECR_full | ECR_empty);
+		break;
+	}
+}
+
+/*****************************************************************************
+* Set the rate the simulated ZVG takes data in ECP mode.
+*
+* Called with:
+*    rate = Bytes a second, or 0 to take it as fast as it's sent.
+*****************************************************************************/
+void zvgSimSetRate( uint rate)
+{
+	SimRate = rate;
+	SimCredit = 0;
+}
+
+/*****************************************************************************
+* Save everything the simulated ZVG receives in ECP mode to a file, or stop
+* saving if 'file' is 0.
+*
+* Returns:
+*    errOk, or errMemory if the file could not be created.
+*****************************************************************************/
+uint zvgSimCapture( const char *file)
+{
+	if (SimCapture != 0)
+	{	fclose( SimCapture);
+		SimCapture = 0;
+	}
+
+	if (file != 0)
+	{	SimCapture = fopen( file, "wb");
+
+		if (SimCapture == 0)
+			return (errMemory);
+	}
+	return (errOk);
+}
+
+/*****************************************************************************
+* Return the totals received by the simulated ZVG.
+*****************************************************************************/
+void zvgSimStats( ZvgSimStats_s *stats)
+{
+	*stats = SimStats;
+}
+
+/*****************************************************************************
+* Print the totals received by the simulated ZVG.
+*****************************************************************************/
+void zvgSimReport( void)
+{
+	double	ff;
+
+	if (SimStats.frames == 0)
+		return;
+
+	ff = SimStats.frames;
+
+	fprintf( stdout, "ZVG simulator: %u frames, %.0f bytes/frame, %.0f vectors/frame (%.2f bytes each)\n",
+		SimStats.frames, SimStats.bytes / ff, SimStats.vectors / ff,
+		SimStats.vectors ? (double)SimStats.bytes / SimStats.vectors : 0.0);
+	fprintf( stdout, "   Per frame: %.0f points, %.0f with start X/Y, %.0f color changes, %.0f NOPs\n",
+		SimStats.points / ff, SimStats.absolutes / ff, SimStats.colors / ff, SimStats.nops / ff);
+
+	if (SimStats.lost)
+		fprintf( stdout, "   Bytes lost: %u\n", SimStats.lost);
+
+	fflush( stdout);
+}
@@ -0,0 +1,302 @@
+/**************************************************************
+
+USB-DVG emulator
+
+Stands in for a USB-DVG board so the DVG driver (and the menu)
+can be run and timed without the hardware. It opens a pseudo
+terminal and prints the name of its slave side, point DVG:port
+in vmmenu.cfg (or DVGPort) at that, or at the link given with -l.
+
+The emulator answers the GET_DVG_INFO request with a JSON block,
+decodes the XY, RGB, COMPLETE and EXIT commands that follow and
+prints the frame rate, bytes and commands per frame once a second
+and again each time the driver closes the port.
+
+With -b it only reads the given number of bytes per second, to
+mimic the USB CDC link of a real board.
+
+Linux only. Build from the top level VMMenu directory with:
+
+gcc -O2 -o dvgemu Utils/dvgemu.c
+
+Usage: dvgemu [-j json file] [-b bytes/sec] [-l link] [-q]
+
+***************************************************************/
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#define FLAG_COMPLETE           0x0
+#define FLAG_RGB                0x1
+#define FLAG_XY                 0x2
+#define FLAG_CMD                0x5
+#define FLAG_SYNC               0x6         // top three bits of a sync pattern byte
+#define FLAG_EXIT               0x7
+#define FLAG_CMD_GET_DVG_INFO   0x1
+
+#define READ_SIZE               4096
+#define JSON_SIZE               4096
+
+static const char default_json[] =
+   "{\"productName\":\"USB-DVG emulator\",\"version\":\"1.0\",\"flipX\":false,"
+   "\"flipY\":false,\"swapXY\":false,\"bwDisplay\":false,\"crtSpeed\":0,"
+   "\"defaultGame\":\"none\"}";
+
+typedef struct
+{
+   double      start;                     // time the first byte arrived
+   double      last;                      // time the last frame completed
+   uint64_t    frames;
+   uint64_t    bytes;                     // including sync patterns
+   uint64_t    cmds;
+   uint64_t    draws;                     // unblanked XY
+   uint64_t    moves;                     // blanked XY
+   uint64_t    colours;
+} stats_t;
+
+static int              master = -1;
+static char             json[JSON_SIZE];
+static int              json_len;
+static const char       *link_name = NULL;
+static volatile int     quit = 0;
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void sleep_for(double secs)
+{
+   struct timespec ts;
+   ts.tv_sec  = (time_t)secs;
+   ts.tv_nsec = (long)((secs - ts.tv_sec) * 1e9);
+   nanosleep(&ts, NULL);
+}
+
+static void on_signal(int sig)
+{
+   (void)sig;
+   quit = 1;
+}
+
+/******************************************************************
+   Print a summary of the frames received
+*******************************************************************/
+static void report(const char *title, stats_t *s)
+{
+   double   t, f;
+   if (s->frames == 0)
+   {
+      return;
+   }
+   t = s->last - s->start;
+   f = s->frames;
+   printf("%s: %llu frames, %.1f fps, %.1f KB/s, %.0f bytes/frame, %.0f cmds/frame "
+          "(%.0f draw, %.0f move, %.0f colour)\n",
+          title, (unsigned long long)s->frames, t > 0 ? f / t : 0.0, t > 0 ? s->bytes / t / 1024 : 0.0,
+          s->bytes / f, s->cmds / f, s->draws / f, s->moves / f, s->colours / f);
+   fflush(stdout);
+}
+
+/******************************************************************
+   Reply to a GET_DVG_INFO request the way the board does, with the
+   command echoed back, then the length of the JSON and the JSON
+*******************************************************************/
+static void send_info(const uint8_t *cmd)
+{
+   if (write(master, cmd, 4) != 4 ||
+       write(master, &json_len, sizeof(json_len)) != sizeof(json_len) ||
+       write(master, json, json_len) != json_len)
+   {
+      printf("Could not send the info reply\n");
+   }
+}
+
+/******************************************************************
+   Count a drawing command
+*******************************************************************/
+static void count(uint32_t cmd, stats_t *s)
+{
+   s->cmds++;
+   switch (cmd >> 29)
+   {
+      case FLAG_XY:
+         if (cmd & (1 << 28)) s->moves++;
+         else                 s->draws++;
+         break;
+      case FLAG_RGB:
+         s->colours++;
+         break;
+      case FLAG_COMPLETE:
+         s->frames++;
+         s->last = now();
+         break;
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   uint8_t     buf[READ_SIZE], cmd[4];
+   uint32_t    c;
+   int         i, n, k = 0, quiet = 0, chunk = READ_SIZE, slave;
+   long        rate = 0;
+   double      t0, next;
+   uint64_t    received = 0;
+   stats_t     total, sec;
+   FILE        *fp;
+   struct termios attr;
+
+   strcpy(json, default_json);
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-j") && (i + 1 < argc))
+      {
+         if ((fp = fopen(argv[++i], "r")) == NULL)
+         {
+            printf("Could not open %s\n", argv[i]);
+            exit(1);
+         }
+         n = fread(json, 1, JSON_SIZE - 1, fp);
+         json[n] = 0;
+         fclose(fp);
+      }
+      else if (!strcmp(argv[i], "-b") && (i + 1 < argc)) rate = atol(argv[++i]);
+      else if (!strcmp(argv[i], "-l") && (i + 1 < argc)) link_name = argv[++i];
+      else if (!strcmp(argv[i], "-q"))                   quiet = 1;
+      else
+      {
+         printf("Usage: dvgemu [-j json file] [-b bytes/sec] [-l link] [-q]\n");
+         exit(1);
+      }
+   }
+   json_len = strlen(json);
+
+   master = posix_openpt(O_RDWR | O_NOCTTY);
+   if ((master < 0) || grantpt(master) || unlockpt(master))
+   {
+      printf("Could not create a pseudo terminal\n");
+      exit(1);
+   }
+
+   // Keep the slave side open so the master doesn't see a hang up
+   // each time the driver closes the port
+   slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+   if (slave >= 0 && tcgetattr(slave, &attr) == 0)
+   {
+      cfmakeraw(&attr);
+      tcsetattr(slave, TCSANOW, &attr);
+   }
+   if (link_name)
+   {
+      unlink(link_name);
+      if (symlink(ptsname(master), link_name))
+      {
+         printf("Could not link %s to %s\n", link_name, ptsname(master));
+         link_name = NULL;
+      }
+   }
+   printf("USB-DVG emulator on %s%s%s\n", ptsname(master), link_name ? ", linked from " : "", link_name ? link_name : "");
+   if (rate > 0)
+   {
+      printf("Limited to %ld bytes/sec\n", rate);
+      chunk = (rate / 100) + 1;                   // read in roughly 10ms slices
+      if (chunk > READ_SIZE) chunk = READ_SIZE;
+   }
+   fflush(stdout);
+
+   signal(SIGINT, on_signal);
+   signal(SIGTERM, on_signal);
+
+   memset(&total, 0, sizeof(total));
+   memset(&sec, 0, sizeof(sec));
+   t0 = 0;
+   next = 0;
+   while (!quit)
+   {
+      n = read(master, buf, chunk);
+      if (n <= 0)
+      {
+         if (quit) break;
+         sleep_for(0.01);
+         continue;
+      }
+      if (received == 0)
+      {
+         t0 = now();
+         next = t0 + 1;
+      }
+      received += n;
+      if (total.start == 0) total.start = now();
+      if (sec.start == 0)   sec.start = now();
+      total.bytes += n;
+      sec.bytes   += n;
+      for (i = 0; i < n; i++)
+      {
+         // Sync bytes only appear between commands
+         if ((k == 0) && ((buf[i] >> 5) == FLAG_SYNC))
+         {
+            continue;
+         }
+         cmd[k++] = buf[i];
+         if (k < 4)
+         {
+            continue;
+         }
+         k = 0;
+         c = ((uint32_t)cmd[0] << 24) | (cmd[1] << 16) | (cmd[2] << 8) | cmd[3];
+         switch (c >> 29)
+         {
+            case FLAG_XY:
+            case FLAG_RGB:
+            case FLAG_COMPLETE:
+               count(c, &sec);
+               count(c, &total);
+               break;
+            case FLAG_CMD:
+               if ((c & 0x1fffffff) == FLAG_CMD_GET_DVG_INFO)
+               {
+                  send_info(cmd);
+               }
+               break;
+            case FLAG_EXIT:
+               // Driver closed the port, print the session and start afresh
+               report("Session", &total);
+               memset(&total, 0, sizeof(total));
+               memset(&sec, 0, sizeof(sec));
+               break;
+            default:
+               printf("Unknown command %08x\n", c);
+               break;
+         }
+      }
+      if (rate > 0)
+      {
+         // Hold back until the link would have carried this much
+         double due = t0 + (double)received / rate;
+         if (due > now()) sleep_for(due - now());
+      }
+      if (!quiet && (next > 0) && (now() >= next))
+      {
+         report("Last second", &sec);
+         memset(&sec, 0, sizeof(sec));
+         next += 1;
+      }
+   }
+   report("Session", &total);
+   if (link_name)
+   {
+      unlink(link_name);
+   }
+   return 0;
+}
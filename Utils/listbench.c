@@ -0,0 +1,240 @@
+/**************************************************************
+
+Games list loading benchmark
+
+Writes a synthetic vmmenu.ini of the given number of entries and
+times loading it with createlist(), against the way the list used
+to be loaded, walking the lists with findmanuf(), findparentgame()
+and gotolastgame()/gotolastclone() for every line. It then checks
+both give exactly the same lists, and that the arrays of games and
+clones createlist() fills in, and nthgame(), match them.
+
+The entries are spread over a few dozen manufacturers, with one
+much bigger than the rest as a Vectrex set from cartlist would be.
+Most games have a few clones, and some clones come before their
+parent or have no parent at all, as happens in real lists.
+
+The file is written to the current directory and deleted
+afterwards, so run it somewhere without a vmmenu.ini of your own.
+
+Build from the top level VMMenu directory with:
+
+gcc -O2 -IVMMSrc -o listbench Utils/listbench.c VMMSrc/gamelist.c
+
+Usage: listbench [entries]
+
+***************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gamelist.h"
+
+#define ENTRIES  20000
+#define MANUFS   40
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/******************************************************************
+   Write n entries to vmmenu.ini
+*******************************************************************/
+static void makeini(int n)
+{
+   FILE  *fp;
+   int   i = 0, game = 0, c, clones, m;
+   fp = fopen("vmmenu.ini", "w");
+   fprintf(fp, "# Synthetic list from listbench\n");
+   srand(1);
+   while (i < n)
+   {
+      m = (rand() % 4) ? rand() % MANUFS : MANUFS;    // a quarter go to the big one
+      clones = (rand() % 3) ? rand() % 4 : 0;
+      if (rand() % 8 == 0)
+      {
+         // a clone before its parent
+         fprintf(fp, "Manuf%02d|Game %d (early clone)|g%d|g%dx\n", m, game, game, game);
+         i++;
+      }
+      if (rand() % 16 == 0)
+      {
+         // a clone whose parent never turns up
+         fprintf(fp, "Manuf%02d|Orphan %d|missing%d|orphan%d\n", m, game, game, game);
+         i++;
+      }
+      else
+      {
+         fprintf(fp, "Manuf%02d|Game %d|g%d|g%d\n", m, game, game, game);
+         i++;
+      }
+      for (c = 0; (c < clones) && (i < n); c++, i++)
+      {
+         fprintf(fp, "Manuf%02d|Game %d (clone %d)|g%d|g%dc%d\n", m, game, c, game, game, c);
+      }
+      game++;
+   }
+   fclose(fp);
+}
+
+/******************************************************************
+   Load vmmenu.ini the way createlist() used to, walking the lists
+   for every line
+*******************************************************************/
+static m_node* oldlist(void)
+{
+   char     temp[260];
+   char     *nl, *manuf, *desc, *mame, *clone;
+   FILE     *fp;
+   m_node   *man_root = NULL, *man_cursor, *man_last;
+   g_node   *game_root, *game_cursor, *game_last;
+
+   fp = fopen("vmmenu.ini", "rt");
+   while (fgets(temp, 250, fp) != NULL)
+   {
+      if ((strlen(temp) > 1) && ((strchr(temp, '#') - temp) != 0) && (strchr(temp, '|') != 0))
+      {
+         manuf = strtok(temp, "|");
+         desc  = strtok(NULL, "|");
+         mame  = strtok(NULL, "|");
+         clone = strtok(NULL, "|");
+         nl = strrchr(clone, '\r');
+         if (nl) *nl = '\0';
+         nl = strrchr(clone, '\n');
+         if (nl) *nl = '\0';
+
+         man_cursor = findmanuf(man_root, manuf);
+         if (man_cursor == NULL)
+         {
+            man_cursor = add_manuf(manuf);
+            man_last = gotolastmanuf(man_root);
+            if (man_last)
+            {
+               man_last->nmanuf = man_cursor;
+               man_cursor->pmanuf = man_last;
+            }
+            if (man_root == NULL) man_root = man_cursor;
+         }
+         game_cursor = add_game(desc, mame, clone);
+         game_root = findparentgame(man_cursor->firstgame, mame);
+         if ((strcmp(clone, mame) == 0) && game_root)
+         {
+            game_cursor->nclone = game_root;
+            game_cursor->next = game_root->next;
+            if (man_cursor->firstgame == game_root) man_cursor->firstgame = game_cursor;
+            else game_root->prev->next = game_cursor;
+            if (game_root->next) game_root->next->prev = game_cursor;
+            game_root->next = NULL;
+            game_cursor->prev = game_root->prev;
+            game_root->prev = NULL;
+         }
+         else if (game_root)
+         {
+            game_last = gotolastclone(game_root);
+            game_last->nclone = game_cursor;
+            game_cursor->pclone = game_last;
+         }
+         else if (man_cursor->firstgame == NULL)
+         {
+            man_cursor->firstgame = game_cursor;
+         }
+         else
+         {
+            game_last = gotolastgame(man_cursor->firstgame);
+            game_last->next = game_cursor;
+            game_cursor->prev = game_last;
+         }
+      }
+   }
+   fclose(fp);
+   return man_root;
+}
+
+/******************************************************************
+   See if two games are the same, and linked to the same games
+*******************************************************************/
+static int samelink(g_node *a, g_node *b)
+{
+   if ((a == NULL) || (b == NULL)) return a == b;
+   return strcmp(a->clone, b->clone) == 0;
+}
+
+static int samegame(g_node *a, g_node *b)
+{
+   return !strcmp(a->name, b->name) && !strcmp(a->parent, b->parent) && !strcmp(a->clone, b->clone)
+      && samelink(a->next, b->next) && samelink(a->prev, b->prev)
+      && samelink(a->nclone, b->nclone) && samelink(a->pclone, b->pclone);
+}
+
+/******************************************************************
+   Compare the lists, and the arrays and nthgame() of the new one.
+   Returns the number of games, or -1 if anything differs.
+*******************************************************************/
+static int samelist(m_node *a, m_node *b)
+{
+   int      n = 0, i, c;
+   g_node   *ga, *gb, *ca, *cb;
+   for (; a && b; a = a->nmanuf, b = b->nmanuf)
+   {
+      if (strcmp(a->name, b->name) || (a->first != n)) return -1;
+      for (i = 0, ga = a->firstgame, gb = b->firstgame; ga && gb; i++, ga = ga->next, gb = gb->next)
+      {
+         if (!samegame(ga, gb) || (i >= a->numgames) || (a->games[i] != ga) || (nthgame(n++) != ga)) return -1;
+         for (c = 0, ca = ga->nclone, cb = gb->nclone; ca && cb; c++, ca = ca->nclone, cb = cb->nclone)
+         {
+            if (!samegame(ca, cb) || (c >= ga->numclones) || (ga->clones[c] != ca) || (nthgame(n++) != ca)) return -1;
+         }
+         if (ca || cb || (c != ga->numclones)) return -1;
+      }
+      if (ga || gb || (i != a->numgames)) return -1;
+   }
+   return (a || b) ? -1 : n;
+}
+
+int main(int argc, char *argv[])
+{
+   int      entries = ENTRIES, n;
+   double   t, tnew, told;
+   m_node   *newlist, *old;
+   FILE     *fp;
+
+   if (argc > 1) entries = atoi(argv[1]);
+   if (entries < 1)
+   {
+      printf("Usage: listbench [entries]\n");
+      exit(1);
+   }
+   if ((fp = fopen("vmmenu.ini", "r")))
+   {
+      fclose(fp);
+      printf("There is already a vmmenu.ini here, run listbench somewhere else\n");
+      exit(1);
+   }
+   makeini(entries);
+
+   t = now();
+   newlist = createlist();
+   tnew = now() - t;
+   t = now();
+   old = oldlist();
+   told = now() - t;
+
+   printf("%d entries\n", entries);
+   printf("createlist()  : %8.2f ms\n", tnew * 1000);
+   printf("linear walks  : %8.2f ms (x%.1f)\n", told * 1000, told / tnew);
+   n = samelist(newlist, old);
+   if (n == entries)
+   {
+      printf("Lists are identical\n");
+   }
+   else
+   {
+      printf("Error - lists differ!\n");
+   }
+   remove("vmmenu.ini");
+   return 0;
+}
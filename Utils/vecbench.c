@@ -0,0 +1,237 @@
+/**************************************************************
+
+USB-DVG vector submission benchmark
+
+Times building frames with one zvgFrameVector() call per vector
+against a single zvgFrameVectors() batch call, and checks both
+produce exactly the same command stream. Then does the same for
+frames of polylines, sent a vector at a time and as strips with
+zvgFrameStrip().
+
+Instead of a real DVG the frames are written to files in the
+current directory, vb_one.bin, vb_batch.bin, vb_lines.bin and
+vb_strip.bin, which are compared in pairs. They are deleted
+afterwards.
+
+Build from the top level VMMenu directory with:
+
+gcc -O2 -DUSBDVG -IWin32/dvg -o vecbench Utils/vecbench.c \
+    Win32/dvg/zvgFrame.c Win32/dvg/timer.c -lpthread -lm
+
+Usage: vecbench [frames] [vectors per frame]
+
+***************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "zvgFrame.h"
+
+#define FRAMES   500
+#define VECTORS  2000
+#define STRIP    20                    // vectors in each polyline
+
+enum modes {ONE, BATCH, LINES, STRIPS};
+
+char  DVGPort[15];                     // the driver opens whatever this names
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/******************************************************************
+   Fill a frame with short vectors, a few of which poke outside
+   the screen so the clipping path gets used as well
+*******************************************************************/
+static void makeframe(vec_t *v, int n)
+{
+   int i, x, y;
+   for (i = 0; i < n; i++)
+   {
+      x = (rand() % (X_MAX - X_MIN + 1)) + X_MIN;
+      y = (rand() % (Y_MAX - Y_MIN + 1)) + Y_MIN;
+      v[i].xStart = x;
+      v[i].yStart = y;
+      if (i % 50 == 0)
+      {
+         v[i].xEnd = x + 400;          // likely off screen
+         v[i].yEnd = y - 300;
+      }
+      else
+      {
+         v[i].xEnd = x + (rand() % 21) - 10;
+         v[i].yEnd = y + (rand() % 21) - 10;
+      }
+      if (i % 4 == 0)                  // chain some, as text does
+      {
+         if (i + 1 < n)
+         {
+            v[i + 1].xStart = v[i].xEnd;
+            v[i + 1].yStart = v[i].yEnd;
+         }
+      }
+   }
+}
+
+/******************************************************************
+   Fill a frame with polylines of STRIP short vectors, as x,y
+   pairs, STRIP + 1 points each. Some wander off the screen.
+*******************************************************************/
+static void makestrips(int *xy, int n)
+{
+   int i, x = 0, y = 0;
+   for (i = 0; i < n; i++)
+   {
+      if (i % (STRIP + 1) == 0)
+      {
+         x = (rand() % (X_MAX - X_MIN + 1)) + X_MIN;
+         y = (rand() % (Y_MAX - Y_MIN + 1)) + Y_MIN;
+      }
+      else
+      {
+         x += (rand() % 41) - 20;
+         y += (rand() % 41) - 20;
+      }
+      xy[i*2]     = x;
+      xy[i*2 + 1] = y;
+   }
+}
+
+/******************************************************************
+   Send frames through the driver, return the time spent adding
+   vectors to them
+*******************************************************************/
+static double run(const char *file, vec_t *v, int *xy, int frames, int vectors, int mode)
+{
+   int      f, i, points = (vectors / STRIP) * (STRIP + 1);
+   double   t, total = 0;
+
+   strcpy(DVGPort, file);
+   if (zvgFrameOpen())
+   {
+      printf("Could not open %s\n", file);
+      exit(1);
+   }
+   zvgFrameSetClipWin(X_MIN, Y_MIN, X_MAX, Y_MAX);
+   srand(1);
+   for (f = 0; f < frames; f++)
+   {
+      if (mode < LINES) makeframe(v, vectors);
+      else makestrips(xy, points);
+      zvgFrameSetRGB15(f & 31, 31, 16);
+      t = now();
+      switch (mode)
+      {
+         case ONE:
+            for (i = 0; i < vectors; i++)
+            {
+               zvgFrameVector(v[i].xStart, v[i].yStart, v[i].xEnd, v[i].yEnd);
+            }
+            break;
+         case BATCH:
+            zvgFrameVectors(v, vectors);
+            break;
+         case LINES:
+            for (i = 1; i < points; i++)
+            {
+               if (i % (STRIP + 1)) zvgFrameVector(xy[i*2 - 2], xy[i*2 - 1], xy[i*2], xy[i*2 + 1]);
+            }
+            break;
+         case STRIPS:
+            for (i = 0; i < points; i += STRIP + 1)
+            {
+               zvgFrameStrip(&xy[i*2], STRIP + 1);
+            }
+            break;
+      }
+      total += now() - t;
+      zvgFrameSend();
+   }
+   zvgFrameClose();
+   return total;
+}
+
+/******************************************************************
+   Compare two files byte for byte
+*******************************************************************/
+static int samefile(const char *a, const char *b)
+{
+   FILE  *fa, *fb;
+   int   ca, cb;
+   fa = fopen(a, "rb");
+   fb = fopen(b, "rb");
+   if (!fa || !fb) return 0;
+   do
+   {
+      ca = fgetc(fa);
+      cb = fgetc(fb);
+   } while ((ca == cb) && (ca != EOF));
+   fclose(fa);
+   fclose(fb);
+   return ca == cb;
+}
+
+int main(int argc, char *argv[])
+{
+   int      frames = FRAMES, vectors = VECTORS;
+   double   t1, tn, tl, ts;
+   vec_t    *v;
+   int      *xy;
+   FILE     *fp;
+
+   if (argc > 1) frames  = atoi(argv[1]);
+   if (argc > 2) vectors = atoi(argv[2]);
+   if ((frames < 1) || (vectors < 1))
+   {
+      printf("Usage: vecbench [frames] [vectors per frame]\n");
+      exit(1);
+   }
+   v  = malloc(vectors * sizeof(vec_t));
+   xy = malloc((vectors / STRIP + 1) * (STRIP + 1) * 2 * sizeof(int));
+
+   // The driver opens an existing device, so create the files first
+   if ((fp = fopen("vb_one.bin", "wb"))) fclose(fp);
+   if ((fp = fopen("vb_batch.bin", "wb"))) fclose(fp);
+   if ((fp = fopen("vb_lines.bin", "wb"))) fclose(fp);
+   if ((fp = fopen("vb_strip.bin", "wb"))) fclose(fp);
+
+   t1 = run("vb_one.bin",   v, xy, frames, vectors, ONE);
+   tn = run("vb_batch.bin", v, xy, frames, vectors, BATCH);
+   tl = run("vb_lines.bin", v, xy, frames, vectors, LINES);
+   ts = run("vb_strip.bin", v, xy, frames, vectors, STRIPS);
+
+   printf("%d frames of %d vectors\n", frames, vectors);
+   printf("zvgFrameVector : %8.2f Mvectors/s\n", frames * vectors / t1 / 1e6);
+   printf("zvgFrameVectors: %8.2f Mvectors/s (x%.2f)\n", frames * vectors / tn / 1e6, t1 / tn);
+   if (samefile("vb_one.bin", "vb_batch.bin"))
+   {
+      printf("Output is identical\n");
+   }
+   else
+   {
+      printf("Error - output differs!\n");
+   }
+   vectors = (vectors / STRIP) * STRIP;
+   printf("Polylines of %d vectors\n", STRIP);
+   printf("zvgFrameVector : %8.2f Mvectors/s\n", frames * vectors / tl / 1e6);
+   printf("zvgFrameStrip  : %8.2f Mvectors/s (x%.2f)\n", frames * vectors / ts / 1e6, tl / ts);
+   if (samefile("vb_lines.bin", "vb_strip.bin"))
+   {
+      printf("Output is identical\n");
+   }
+   else
+   {
+      printf("Error - output differs!\n");
+   }
+   remove("vb_one.bin");
+   remove("vb_batch.bin");
+   remove("vb_lines.bin");
+   remove("vb_strip.bin");
+   free(v);
+   free(xy);
+   return 0;
+}
@@ -0,0 +1,205 @@
+/**************************************************************
+
+ZVG encoder and transmit benchmark
+
+Runs frames through the ZVG driver built with ZVGSIM, so the
+parallel port and the ZVG on the end of it are simulated (see
+Linux/zvg/zvgSim.c) and no hardware or root is needed.
+
+For each frame it times encoding the vectors, then sending the
+frame with the transmit thread off, so the send time is the
+whole cost of getting one frame out through the port driver.
+The simulated ZVG decodes what arrives, which gives the bytes
+per vector and checks every frame got there.
+
+With -w the bytes the simulated ZVG receives are saved to a file,
+with -c they are compared against a file saved earlier, so a
+change to the encoder can be checked to give exactly the same
+output. Set ZVGPORT (e.g. "M3") to check flipped axes as well.
+
+The link rate of the simulated ZVG can be given in bytes/sec,
+without one it takes data as fast as the driver can send it.
+With a rate set, a few bytes (NOPs) are reported lost, as the
+driver leaves ECP mode to read from the ZVG without waiting for
+the FIFO to empty. A real port drops them the same way.
+
+Build from the top level VMMenu directory with:
+
+gcc -O2 -DZVGSIM -ILinux/zvg -o zvgbench Utils/zvgbench.c \
+    Linux/zvg/zvgFrame.c Linux/zvg/zvgEnc.c Linux/zvg/zvgPort.c \
+    Linux/zvg/zvgPpdev.c Linux/zvg/zvgSim.c Linux/zvg/zvgError.c \
+    Linux/zvg/zvgBan.c Linux/zvg/timer.c -lpthread -lm
+
+Usage: zvgbench [-w file | -c file] [frames] [vectors per frame] [bytes/sec]
+
+***************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "zvgFrame.h"
+
+#define FRAMES   500
+#define VECTORS  2000
+#define CAPTURE  "zb_out.bin"            // output saved here for -c
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/******************************************************************
+   Fill a frame with short vectors, a few of which poke outside
+   the screen so the clipping path gets used as well
+*******************************************************************/
+static void makeframe(vec_t *v, int n)
+{
+   int i, x, y;
+   for (i = 0; i < n; i++)
+   {
+      x = (rand() % (X_MAX - X_MIN + 1)) + X_MIN;
+      y = (rand() % (Y_MAX - Y_MIN + 1)) + Y_MIN;
+      v[i].xStart = x;
+      v[i].yStart = y;
+      if (i % 50 == 0)
+      {
+         v[i].xEnd = x + 400;          // likely off screen
+         v[i].yEnd = y - 300;
+      }
+      else if (i % 50 == 25)
+      {
+         v[i].xEnd = -x;               // long, through the middle
+         v[i].yEnd = -y;
+      }
+      else
+      {
+         v[i].xEnd = x + (rand() % 21) - 10;
+         v[i].yEnd = y + (rand() % 21) - 10;
+      }
+      if (i % 4 == 0)                  // chain some, as text does
+      {
+         if (i + 1 < n)
+         {
+            v[i + 1].xStart = v[i].xEnd;
+            v[i + 1].yStart = v[i].yEnd;
+         }
+      }
+   }
+}
+
+/******************************************************************
+   Compare two files byte for byte
+*******************************************************************/
+static int samefile(const char *a, const char *b)
+{
+   FILE  *fa, *fb;
+   int   ca, cb;
+   fa = fopen(a, "rb");
+   fb = fopen(b, "rb");
+   if (!fa || !fb) return 0;
+   do
+   {
+      ca = fgetc(fa);
+      cb = fgetc(fb);
+   } while ((ca == cb) && (ca != EOF));
+   fclose(fa);
+   fclose(fb);
+   return ca == cb;
+}
+
+int main(int argc, char *argv[])
+{
+   int            frames = FRAMES, vectors = VECTORS, f, i, n = 0;
+   unsigned int   err, rate = 0;
+   double         t, tenc = 0, tsend = 0;
+   const char     *save = NULL, *check = NULL;
+   vec_t          *v;
+   ZvgSimStats_s  s0, s1;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-w") && (i + 1 < argc))      save = argv[++i];
+      else if (!strcmp(argv[i], "-c") && (i + 1 < argc)) check = argv[++i];
+      else if (n == 0) frames  = atoi(argv[i]), n++;
+      else if (n == 1) vectors = atoi(argv[i]), n++;
+      else if (n == 2) rate    = atoi(argv[i]), n++;
+      else frames = 0;
+   }
+   if ((frames < 1) || (vectors < 1) || (save && check))
+   {
+      printf("Usage: zvgbench [-w file | -c file] [frames] [vectors per frame] [bytes/sec]\n");
+      exit(1);
+   }
+   v = malloc(vectors * sizeof(vec_t));
+
+   zvgSimSetRate(rate);
+   if (save || check)
+   {
+      if (zvgSimCapture(save ? save : CAPTURE))
+      {
+         printf("Could not create %s\n", save ? save : CAPTURE);
+         exit(1);
+      }
+   }
+   if ((err = zvgFrameOpen()))
+   {
+      zvgError(err);
+      printf("\nCould not open the simulated ZVG\n");
+      exit(1);
+   }
+   printf("Found %s, firmware %04X\n", ZvgID.mdl, ZvgID.fVer);
+
+   // Send each frame as it's built, so its send time can be measured
+   zvgDmaAsync(zFalse);
+   zvgFrameSetClipWin(X_MIN, Y_MIN, X_MAX, Y_MAX);
+   zvgSimStats(&s0);
+   srand(1);
+   for (f = 0; f < frames; f++)
+   {
+      makeframe(v, vectors);
+      t = now();
+      zvgFrameSetRGB15(f & 31, 31, 16);
+      for (i = 0; i < vectors; i++)
+      {
+         zvgFrameVector(v[i].xStart, v[i].yStart, v[i].xEnd, v[i].yEnd);
+      }
+      tenc += now() - t;
+      t = now();
+      if ((err = zvgFrameSend()))
+      {
+         zvgError(err);
+         printf("\nFrame %d could not be sent\n", f);
+         break;
+      }
+      tsend += now() - t;
+   }
+   zvgSimStats(&s1);
+   zvgFrameClose();
+   zvgSimCapture(NULL);
+
+   printf("%d frames of %d vectors%s", f, vectors, rate ? "" : "\n");
+   if (rate) printf(", link limited to %u bytes/sec\n", rate);
+   if (f == 0) exit(1);
+   printf("Encoder : %8.2f Mvectors/s, %.2f bytes/vector\n",
+      (double)f * vectors / tenc / 1e6, (double)(s1.bytes - s0.bytes) / (s1.vectors - s0.vectors));
+   printf("Transmit: %8.3f ms/frame, %.0f bytes/frame, %.2f MB/s\n",
+      tsend * 1000 / f, (double)(s1.bytes - s0.bytes) / f, (s1.bytes - s0.bytes) / tsend / 1e6);
+   zvgSimReport();
+   if (check)
+   {
+      if (samefile(check, CAPTURE))
+      {
+         printf("Output is identical to %s\n", check);
+      }
+      else
+      {
+         printf("Error - output differs from %s!\n", check);
+      }
+      remove(CAPTURE);
+   }
+   free(v);
+   return 0;
+}
@@ -14,6 +14,10 @@
    #include <SDL_mixer.h>
 #endif
 #include "zvgFrame.h"
+#include "vframe.h"
+#include "vtext.h"
+#include "vlod.h"
+#include "vsimp.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -38,9 +42,35 @@ int            optz[16];                  // array of user defined menu preferen
 int            keyz[11];                  // array of key press codes
 extern int     mousefound;
 extern char    DVGPort[15];
-uint32_t       timestart = 0, timenow, duration;
 int            vector_count=0, colour_sets=0;
 extern int 	   jsdeadzone;
+extern int     beamopt;
+extern int     colourgroup;
+extern int     framerate;
+extern int     benchframes;
+extern int     autodetail;
+static double  *benchtimes = NULL;        // zvgFrameSend() times (ms) in benchmark mode
+static int     benchcount = 0, benchsize = 0;
+static Uint64  benchstart;
+static unsigned int framessent = 0;       // frames sent since startup, paced or not
+
+typedef struct
+{
+   float    x1, y1, x2, y2;       // screen co-ordinates, after rotation
+   int      colour, bright;
+} l_vector;
+
+typedef struct
+{
+   l_vector *vecs;
+   int      count, size;
+   int      valid;                // vecs holds what the layer drew last time
+} v_layer;
+
+static v_layer layers[NUM_LAYERS];   // vectors of each layer of the menu screen, see layer_begin()
+static int     recording = -1;       // layer being recorded, -1 for none
+
+#define STRIP_POINTS 64              // most points of a polyline sent to the VG in one strip
 
 enum vsounds
 {
@@ -64,9 +94,6 @@ Mix_Chunk      *aExplode2 = NULL;
 Mix_Chunk      *aExplode3 = NULL;
 Mix_Chunk      *aNuke     = NULL;
 
-#define		fps     60
-#define		fps_ms  1000/fps
-
 #define MAX_CONTROLLERS  8
 
 SDL_GameController* s_controllers[MAX_CONTROLLERS];
@@ -80,6 +107,7 @@ static int s_joystick_cnt;
 void startZVG(void)
 {
    unsigned int error;
+   tmrStats_t   stats;
    #if DEBUG
       printf("Key UP:       0x%04x\n", UP);
       printf("Key DOWN:     0x%04x\n", DOWN);
@@ -110,12 +138,24 @@ void startZVG(void)
       zvgError(error);             // print error
       printf("Vector Generator hardware not found, rendering to SDL window only.\n");
       ZVGPresent = 0;
+      tmrInit();                   // the SDL window is paced by the same timer
    }
-   else
+
+   // The USB-DVG driver sets its own rate, 45fps. The drivers only set
+   // theirs the first time they are opened, so this rate, and the pacing
+   // stats, carry on after RunGame() closes and reopens them.
+   if (framerate > 0)
+      tmrSetFrameRate(framerate);
+   else if (ZVGPresent != 2)
+      tmrSetFrameRate(FRAMES_PER_SEC);
+
+   if (ZVGPresent)
    {
-      if (ZVGPresent != 2) 
-          tmrSetFrameRate(FRAMES_PER_SEC);
       zvgFrameSetClipWin( X_MIN, Y_MIN, X_MAX, Y_MAX);
+      vframe_mode(beamopt);
+      vframe_group(colourgroup);
+      tmrGetStats(&stats);
+      vlod_init(stats.fps);
    }
 
    #ifdef USBDVG
@@ -377,15 +417,6 @@ void FrameSendSDL()
       SDL_SetRenderDrawColor(screenRender, 0, 0, 0, 255); // Set render colour to black
       SDL_RenderClear(screenRender);                      // Clear screen
    }
-   timenow = SDL_GetTicks();
-   duration = (timenow-timestart);
-   //printf("Start: %i\t| Time: %i\t| Loop duration: %i\t| Wait time: %i  \t| FPS ms: %i\t| VC: %i\t| CC: %i\n", timestart, timenow, duration, fps_ms-duration, fps_ms, vector_count, colour_sets);
-   //if (!ZVGPresent)
-   {
-      if (duration < fps_ms) SDL_Delay(fps_ms-duration);
-      //if ((duration < fps_ms) && ((fps_ms-duration)>0)) SDL_Delay(fps_ms-duration);
-   }
-   timestart=SDL_GetTicks();
    vector_count=0;
    colour_sets=0;
 }
@@ -522,24 +553,104 @@ void mousepos(int *mx, int *my)
 }
 
 
+/******************************************************
+Note how long a frame took to send, in benchmark mode
+*******************************************************/
+static void benchrecord(Uint64 start, Uint64 end)
+{
+   double *t;
+   if (benchcount == 0) benchstart = start;
+   if (benchcount == benchsize)
+   {
+      benchsize = benchsize ? benchsize * 2 : 4096;
+      t = realloc(benchtimes, benchsize * sizeof(double));
+      if (t == NULL)
+      {
+         benchsize = benchcount;
+         return;
+      }
+      benchtimes = t;
+   }
+   benchtimes[benchcount++] = (end - start) * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+
+static int cmpdouble(const void *a, const void *b)
+{
+   double d = *(const double *)a - *(const double *)b;
+   return (d > 0) - (d < 0);
+}
+
+
+/******************************************************
+Print the frame rate and frame send times measured in
+benchmark mode
+*******************************************************/
+static void benchreport(void)
+{
+   double secs;
+   if (benchcount == 0)
+   {
+      printf("Benchmark: no frames were sent to the vector generator\n");
+      return;
+   }
+   secs = (SDL_GetPerformanceCounter() - benchstart) / (double)SDL_GetPerformanceFrequency();
+   qsort(benchtimes, benchcount, sizeof(double), cmpdouble);
+   printf("Benchmark: %d frames in %.2fs, %.1f fps\n", benchcount, secs, benchcount / secs);
+   printf("Frame send time: p50 %.3fms, p99 %.3fms, max %.3fms\n",
+      benchtimes[benchcount / 2], benchtimes[(benchcount * 99) / 100], benchtimes[benchcount - 1]);
+   free(benchtimes);
+   benchtimes = NULL;
+   benchcount = benchsize = 0;
+}
+
+
 /******************************************************
 Send the frame to the ZVG, exit if it went pear shaped
 *******************************************************/
 int sendframe(void)
 {
    unsigned int   err=0;
+   unsigned int   frames, bytes;
+   static int     warned = 0;
+   Uint64         t;
+   if (!benchframes)
+   {
+      tmrWaitForFrame();         // wait for next frame time, paces the SDL window too
+   }
+   framessent++;
    if (ZVGPresent)
    {
-      tmrWaitForFrame();      // wait for next frame time
-      //printf("Sending frame to DVG...");
-      err = zvgFrameSend();     // send next frame
-      //printf(" frame sent.\n");
+      vframe_flush();         // send any vectors held back for reordering
+      if (benchframes)
+      {
+         // Flat out, timing each send
+         t = SDL_GetPerformanceCounter();
+         err = zvgFrameSend();
+         benchrecord(t, SDL_GetPerformanceCounter());
+      }
+      else
+      {
+         //printf("Sending frame to DVG...");
+         err = zvgFrameSend();     // send next frame
+         //printf(" frame sent.\n");
+      }
       if (err)
       {
          zvgError( err);
          zvgFrameClose();       // fix up all the ZVG stuff
          exit(1);
       }
+      if (autodetail && !benchframes)
+      {
+         vlod_frame(vector_count);     // drop or restore detail to keep up with the VG
+      }
+      zvgFrameOverflowStats(&frames, &bytes);
+      if (frames && !warned)  // only say so once, it'll likely happen every frame
+      {
+         printf("Warning: frame too large for the vector generator, some vectors were not drawn\n");
+         warned = 1;
+      }
    }
    FrameSendSDL();
    return err;
@@ -551,7 +662,17 @@ Close everything off for a graceful exit
 *******************************************************/
 void ShutdownAll(void)
 {
+   tmrStats_t  stats;
+   int         report = DEBUG || benchframes;    // print the diagnostics, in debug builds and -bench runs
    CloseSDL(1);
+   tmrGetStats(&stats);
+   if (report && stats.frames)
+   {
+      printf("Frame pacing: %u frames at %dfps, %u missed, late by %.0fus mean, %lldus p99, %lldus max\n",
+         stats.frames, stats.fps, stats.missed, (double)stats.lateSum / stats.frames, stats.lateP99, stats.lateMax);
+   }
+   if (report) vtext_report();
+   if (report) vsimp_report(framessent);      // the timer doesn't count frames under -bench
    #if defined(linux) || defined(__linux)
       setLEDs(8);
    #else
@@ -559,7 +680,20 @@ void ShutdownAll(void)
    #endif
    if (ZVGPresent)
    {
+      unsigned int frames, bytes;
+      zvgFrameRepeatStats(&frames, &bytes);
+      if (report) printf("Unchanged frames repeated rather than built: %u (%u bytes not sent)\n", frames, bytes);
+      zvgFrameOverflowStats(&frames, &bytes);
+      if (frames) printf("Frames with vectors dropped: %u (%u bytes)\n", frames, bytes);
+      zvgFrameStallStats(&frames, &bytes);
+      if (report && frames) printf("Frames that waited for the last one to be sent: %u (%ums)\n", frames, bytes);
+      if (benchframes) benchreport();
+      if (report) vframe_report();
+      if (report) vlod_report();
       zvgFrameClose();                            // fix up all the ZVG stuff
+      #ifdef ZVGSIM
+         zvgSimReport();
+      #endif
    }
 }
 
@@ -576,7 +710,7 @@ void setcolour(int clr, int bright)
    GetRGBfromColour(clr, &r, &g, &b);
    if (ZVGPresent)
    {
-      zvgFrameSetRGB15(r*bright, g*bright, b*bright);
+      vframe_colour(r*bright, g*bright, b*bright);
    }
    SDL_VC = clr;      // a bit hacky, it was a late addition.
    SDL_VB = bright;   // should pass as parameters to draw functions
@@ -585,48 +719,215 @@ void setcolour(int clr, int bright)
 
 
 /*******************************************************************
- Draw a vector - pass the start, end points, and the x and y offsets
- Uses global rotation variable to determine orientation
+ Add a vector, already in screen co-ordinates, to the layer being
+ recorded, if there is one
 ********************************************************************/
-void drawvector(point p1, point p2, float x_trans, float y_trans)
+static void recordvector(float x1, float y1, float x2, float y2)
 {
-   // Standard - no rotation
-   vector_count++;    // For debug, count the number of vectors drawn/frame
-   if (optz[o_rot] == 0)
+   v_layer  *l;
+   l_vector *v;
+   if (recording < 0) return;
+   l = &layers[recording];
+   if (l->count == l->size)
    {
-      if (ZVGPresent)
+      v = realloc(l->vecs, (l->size ? l->size * 2 : 256) * sizeof(l_vector));
+      if (v == NULL)
       {
-         zvgFrameVector(p1.x + x_trans, p1.y + y_trans, p2.x + x_trans, p2.y + y_trans);
+         // out of memory, draw the layer in full next frame
+         l->valid  = 0;
+         recording = -1;
+         return;
       }
-      SDLvector(p1.x + x_trans, p1.y + y_trans, p2.x + x_trans, p2.y + y_trans, SDL_VC, SDL_VB);
+      l->vecs = v;
+      l->size = l->size ? l->size * 2 : 256;
+   }
+   v = &l->vecs[l->count++];
+   v->x1     = x1;
+   v->y1     = y1;
+   v->x2     = x2;
+   v->y2     = y2;
+   v->colour = SDL_VC;
+   v->bright = SDL_VB;
+}
+
+
+/*******************************************************************
+ Send a vector, already in screen co-ordinates, to the VG and SDL
+ and add it to the layer being recorded, if there is one
+********************************************************************/
+static void emitvector(float x1, float y1, float x2, float y2)
+{
+   vector_count++;    // For debug, count the number of vectors drawn/frame
+   if (ZVGPresent)
+   {
+      vframe_vector(x1, y1, x2, y2);
    }
-   // rotated LEFT (90° CW)
-   if (optz[o_rot] == 1)
+   SDLvector(x1, y1, x2, y2, SDL_VC, SDL_VB);
+   recordvector(x1, y1, x2, y2);
+}
+
+
+/*******************************************************************
+ Send a strip of joined vectors through n points, already in screen
+ co-ordinates, to the VG in one go, and each vector to SDL and the
+ layer being recorded
+********************************************************************/
+static void emitstrip(const float *x, const float *y, int n)
+{
+   int i, xy[STRIP_POINTS * 2];
+   if (n < 2) return;
+   vector_count += n - 1;
+   if (ZVGPresent)
    {
-      if (ZVGPresent)
+      for (i = 0; i < n; i++)
       {
-         zvgFrameVector(p1.y + y_trans, -(p1.x + x_trans), p2.y + y_trans, -(p2.x + x_trans));
+         xy[i*2]     = x[i];
+         xy[i*2 + 1] = y[i];
       }
-      SDLvector(p1.y + y_trans, -(p1.x + x_trans), p2.y + y_trans, -(p2.x + x_trans), SDL_VC, SDL_VB);
+      vframe_strip(xy, n);
    }
-   // Rotated 180°
-   if (optz[o_rot] == 2)
+   for (i = 1; i < n; i++)
    {
-      if (ZVGPresent)
+      SDLvector(x[i - 1], y[i - 1], x[i], y[i], SDL_VC, SDL_VB);
+      recordvector(x[i - 1], y[i - 1], x[i], y[i]);
+   }
+}
+
+
+/*******************************************************************
+ Draw a vector - pass the start, end points, and the x and y offsets
+ Uses global rotation variable to determine orientation
+********************************************************************/
+void drawvector(point p1, point p2, float x_trans, float y_trans)
+{
+   switch (optz[o_rot])
+   {
+      case 0:     // Standard - no rotation
+         emitvector(p1.x + x_trans, p1.y + y_trans, p2.x + x_trans, p2.y + y_trans);
+         break;
+      case 1:     // rotated LEFT (90° CW)
+         emitvector(p1.y + y_trans, -(p1.x + x_trans), p2.y + y_trans, -(p2.x + x_trans));
+         break;
+      case 2:     // Rotated 180°
+         emitvector(-(p1.x + x_trans), -(p1.y + y_trans), -(p2.x + x_trans), -(p2.y + y_trans));
+         break;
+      case 3:     // rotated RIGHT (90° CCW)
+         emitvector(-(p1.y + y_trans), (p1.x + x_trans), -(p2.y + y_trans), (p2.x + x_trans));
+         break;
+   }
+}
+
+
+/*******************************************************************
+ Draw a vector from x1,y1 to x2,y2 through transform m, which
+ already includes the screen rotation (see screenmatrix())
+********************************************************************/
+void drawxform(vmatrix *m, float x1, float y1, float x2, float y2)
+{
+   emitvector(m->a * x1 + m->b * y1 + m->tx, m->c * x1 + m->d * y1 + m->ty,
+              m->a * x2 + m->b * y2 + m->tx, m->c * x2 + m->d * y2 + m->ty);
+}
+
+
+/*******************************************************************
+ Draw lines joining n points, through transform m, which already
+ includes the screen rotation. A point with x of PEN_UP lifts the
+ pen, and the next line starts at the point after it. Each point
+ is transformed once, and each line goes to the VG as one strip.
+********************************************************************/
+void drawpolyline(vmatrix *m, const point *p, int n)
+{
+   int   i, k = 0;
+   float x[STRIP_POINTS], y[STRIP_POINTS];
+   for (i = 0; i < n; i++, p++)
+   {
+      if (p->x == PEN_UP)
+      {
+         emitstrip(x, y, k);
+         k = 0;
+         continue;
+      }
+      if (k == STRIP_POINTS)
       {
-         zvgFrameVector(-(p1.x + x_trans), -(p1.y + y_trans), -(p2.x + x_trans), -(p2.y + y_trans));
+         // carry on from the last point sent
+         emitstrip(x, y, k);
+         x[0] = x[k - 1];
+         y[0] = y[k - 1];
+         k = 1;
       }
-      SDLvector(-(p1.x + x_trans), -(p1.y + y_trans), -(p2.x + x_trans), -(p2.y + y_trans), SDL_VC, SDL_VB);
+      x[k] = m->a * p->x + m->b * p->y + m->tx;
+      y[k] = m->c * p->x + m->d * p->y + m->ty;
+      k++;
    }
-   // rotated RIGHT (90° CCW)
-   if (optz[o_rot] == 3)
+   emitstrip(x, y, k);
+}
+
+
+/*******************************************************************
+ Start drawing a layer of the screen. If nothing in it has changed
+ (redraw is 0) the vectors it drew last time are sent again and it
+ returns 0. Vectors of the same colour that join end to start go
+ out as strips, as they did when the layer was drawn. Otherwise it
+ returns 1, and the vectors drawn until layer_end() are recorded
+ for the next frame.
+********************************************************************/
+int layer_begin(int layer, int redraw)
+{
+   int      i, n = 0, c = -1, b = -1;
+   float    x[STRIP_POINTS], y[STRIP_POINTS];
+   l_vector *v;
+   if (!redraw && layers[layer].valid)
    {
-      if (ZVGPresent)
+      v = layers[layer].vecs;
+      for (i = 0; i < layers[layer].count; i++, v++)
       {
-         zvgFrameVector(-(p1.y + y_trans), (p1.x + x_trans), -(p2.y + y_trans), (p2.x + x_trans));
+         if ((v->colour != c) || (v->bright != b))
+         {
+            emitstrip(x, y, n);
+            n = 0;
+            setcolour(v->colour, v->bright);
+            c = v->colour;
+            b = v->bright;
+         }
+         if (n && ((v->x1 != x[n - 1]) || (v->y1 != y[n - 1])))
+         {
+            emitstrip(x, y, n);     // not joined to the last one
+            n = 0;
+         }
+         if (n == STRIP_POINTS)
+         {
+            // carry on from the last point sent
+            emitstrip(x, y, n);
+            x[0] = x[n - 1];
+            y[0] = y[n - 1];
+            n = 1;
+         }
+         if (n == 0)
+         {
+            x[0] = v->x1;
+            y[0] = v->y1;
+            n = 1;
+         }
+         x[n] = v->x2;
+         y[n] = v->y2;
+         n++;
       }
-      SDLvector(-(p1.y + y_trans), (p1.x + x_trans), -(p2.y + y_trans), (p2.x + x_trans), SDL_VC, SDL_VB);
+      emitstrip(x, y, n);
+      return 0;
    }
+   layers[layer].count = 0;
+   layers[layer].valid = 1;
+   recording = layer;
+   return 1;
+}
+
+
+/*******************************************************************
+ Stop recording the layer started by layer_begin()
+********************************************************************/
+void layer_end(void)
+{
+   recording = -1;
 }
 
 
@@ -14,6 +14,10 @@ void  processmouse(void);                               // Process mouse/spinner
 int   sendframe(void);                                  // Send a frame to the VG and/or SDL
 void  ShutdownAll(void);                                // Shutdown the VG and SDL
 void  drawvector(point, point, float, float);           // draw a vector between 2 points
+void  drawxform(vmatrix*, float, float, float, float);  // draw a vector through a transform
+void  drawpolyline(vmatrix*, const point*, int);        // draw joined vectors through points, via a transform
+int   layer_begin(int, int);                            // redraw a layer (returns 1), or resend it as last drawn
+void  layer_end(void);                                  // end of a layer being redrawn
 void	RunGame(char*);                                   // Generate command to run a game
 void  FrameSendSDL(void);                               // Send a frame to the SDL surface
 void  SDLvector(float, float, float, float, int, int);  // Draw a vector on the SDL surface
@@ -11,6 +11,33 @@ to operate on the list
 #include <string.h>
 #include <gamelist.h>
 
+// An entry in the hash table used while loading the list
+typedef struct
+{
+   unsigned int   hash;
+   void           *owner;        // manufacturer of a game, NULL for a manufacturer
+   const char     *name;         // name of the manufacturer, or parent of the game
+   void           *node;         // the m_node or g_node, NULL if the entry is empty
+   g_node         *last;         // last game of a manufacturer, or last clone of a game
+} l_entry;
+
+typedef struct
+{
+   l_entry        *entries;
+   unsigned int   mask;          // size of the table - 1, the size is a power of 2
+   unsigned int   count;         // entries in use
+} l_table;
+
+// A game at the top of a manufacturer's list, for finding the nth game
+typedef struct
+{
+   g_node         *game;
+   int            first;         // number of games and clones before it, in all the manufacturers
+} l_top;
+
+static l_top      *tops = NULL;  // every top game of the last list loaded, in order
+static int        numtops = 0;
+
 
 /**************************************
       Print out the linked list
@@ -60,7 +87,7 @@ void linklist(m_node *list)
    while (list)
    {
       firstgame = list->firstgame;
-      lastgame = gotolastgame(firstgame);
+      lastgame = list->games[list->numgames - 1];
       lastgame->next = firstgame;
       firstgame->prev = lastgame;
       list = list->nmanuf;
@@ -81,6 +108,9 @@ m_node* add_manuf(char *manuf)
    newrec->nmanuf = NULL;
    newrec->pmanuf = NULL;
    newrec->firstgame = NULL;
+   newrec->games = NULL;
+   newrec->numgames = 0;
+   newrec->first = 0;
    return newrec;
 }
 
@@ -99,6 +129,8 @@ g_node* add_game(char *gamename, char *mamename, char *clonename)
    newrec->prev = NULL;
    newrec->nclone = NULL;
    newrec->pclone = NULL;
+   newrec->clones = NULL;
+   newrec->numclones = 0;
    return newrec;
 }
 
@@ -194,8 +226,155 @@ g_node* gotolastclone(g_node *gamelist)
 }
 
 
+/**************************************
+ Hash a name, with the manufacturer it
+ belongs to (if any) mixed in
+**************************************/
+static unsigned int hashname(void *owner, const char *name)
+{
+   unsigned int h = 2166136261u ^ (unsigned int)(size_t)owner;
+   while (*name)
+      h = (h ^ (unsigned char)*name++) * 16777619u;
+   return h;
+}
+
+
+/**************************************
+ Find the entry for a manufacturer (with
+ owner NULL), or for the game at the top
+ of a manufacturer's list with the given
+ parent. Returns an empty entry to fill
+ in if there isn't one.
+**************************************/
+static l_entry* findentry(l_table *table, void *owner, const char *name)
+{
+   unsigned int   h = hashname(owner, name), i;
+   l_entry        *e;
+   for (i = h & table->mask; ; i = (i + 1) & table->mask)
+   {
+      e = &table->entries[i];
+      if (e->node == NULL)
+      {
+         e->hash  = h;
+         e->owner = owner;
+         return e;
+      }
+      if ((e->hash == h) && (e->owner == owner) && (strcmp(e->name, name) == 0))
+         return e;
+   }
+}
+
+
+/**************************************
+ Make room for two more entries, doubling
+ the table when it would get over half
+ full. The entries are put back in their
+ places in the bigger table.
+**************************************/
+static int growtable(l_table *table)
+{
+   l_table     bigger;
+   l_entry     *e;
+   unsigned int i, size = table->entries ? table->mask + 1 : 0;
+   if (table->count + 2 <= size / 2)
+      return 1;
+   size = size ? size * 2 : 256;
+   bigger.entries = (l_entry *)calloc(size, sizeof(l_entry));
+   if (bigger.entries == NULL)
+      return 0;
+   bigger.mask  = size - 1;
+   bigger.count = table->count;
+   for (i = 0; table->entries && (i <= table->mask); i++)
+   {
+      if (table->entries[i].node == NULL) continue;
+      e = &bigger.entries[table->entries[i].hash & bigger.mask];
+      while (e->node)
+         e = &bigger.entries[((e - bigger.entries) + 1) & bigger.mask];
+      *e = table->entries[i];
+   }
+   free(table->entries);
+   *table = bigger;
+   return 1;
+}
+
+
+/**************************************
+ Fill in the arrays of each manufacturer's
+ games and each game's clones, all from
+ one block, and the table of top games
+ with the running count of games before
+ each one
+**************************************/
+static void indexlist(m_node *list, int total)
+{
+   int      count = 0;
+   g_node   **block, *game, *clone;
+   block = (g_node **)malloc((total + 1) * sizeof(g_node *));
+   free(tops);
+   tops = (l_top *)malloc((total + 1) * sizeof(l_top));
+   if ((block == NULL) || (tops == NULL))
+   {
+      printf("* Fatal Error - Out of memory loading vmmenu.ini\n");
+      exit(1);
+   }
+   numtops = 0;
+   for (; list; list = list->nmanuf)
+   {
+      list->first = count;
+      list->games = block;
+      list->numgames = 0;
+      for (game = list->firstgame; game; game = game->next)
+         list->games[list->numgames++] = game;
+      block += list->numgames;
+      for (game = list->firstgame; game; game = game->next)
+      {
+         game->clones = block;
+         game->numclones = 0;
+         for (clone = game->nclone; clone; clone = clone->nclone)
+            game->clones[game->numclones++] = clone;
+         block += game->numclones;
+         tops[numtops].game = game;
+         tops[numtops].first = count;
+         numtops++;
+         count += game->numclones + 1;
+      }
+   }
+}
+
+
+/**************************************
+ Return the nth game or clone (from 0)
+ of the last list loaded, counting each
+ game then its clones, manufacturer by
+ manufacturer
+**************************************/
+g_node* nthgame(int n)
+{
+   int      lo = 0, hi = numtops - 1, mid;
+   g_node   *game;
+   while (lo < hi)                           // find the last top game with no more than n before it
+   {
+      mid = (lo + hi + 1) / 2;
+      if (tops[mid].first <= n) lo = mid;
+      else hi = mid - 1;
+   }
+   game = tops[lo].game;
+   n -= tops[lo].first;
+   if (n > game->numclones) n = game->numclones;
+   return n ? game->clones[n - 1] : game;
+}
+
+
 /**************************************
  Create games list from the input file
+
+ Manufacturers, and the game at the top
+ of each manufacturer's list for each
+ parent, are looked up in a hash table
+ rather than by walking the lists, and
+ the last game or clone of each is kept
+ there so new ones can be added to the
+ end straight away.
 **************************************/
 m_node* createlist()
 {
@@ -203,9 +382,12 @@ m_node* createlist()
    char     *nl;
    char     smanuf[30], sdesc[60], smame[128], sclone[128];
    char     *manuf=smanuf, *desc=sdesc, *mame=smame, *clone=sclone;
+   int      total = 0;
    FILE     *fp;
    m_node   *man_root = NULL, *man_cursor = NULL, *man_last = NULL;
-   g_node   *game_root = NULL, *game_cursor = NULL, *game_last = NULL;
+   g_node   *game_root = NULL, *game_cursor = NULL;
+   l_table  table = {NULL, 0, 0};
+   l_entry  *m_entry, *g_entry;
 
    fp = fopen ("vmmenu.ini","rt" );
    if (fp == NULL)
@@ -228,11 +410,16 @@ m_node* createlist()
          nl = strrchr(clone, '\n');
          if (nl) *nl = '\0';
 
-         man_cursor = findmanuf(man_root, manuf);
-         if (man_cursor == NULL)
+         if (!growtable(&table))                         // room for a manufacturer and a game
+         {
+            printf("* Fatal Error - Out of memory loading vmmenu.ini\n");
+            exit(1);
+         }
+
+         m_entry = findentry(&table, NULL, manuf);
+         if (m_entry->node == NULL)
          {
             man_cursor = add_manuf(manuf);
-            man_last = gotolastmanuf(man_root);
             if (man_last)
             {
                man_last->nmanuf = man_cursor;            // pevious last->next = this record
@@ -240,15 +427,23 @@ m_node* createlist()
             }
             if (man_root == NULL)
                man_root = man_cursor;                    // this is the first item
+            man_last = man_cursor;
+            m_entry->node = man_cursor;
+            m_entry->name = man_cursor->name;
+            m_entry->last = NULL;
+            table.count++;
          }
+         man_cursor = (m_node *)m_entry->node;
 
          // when we get to here, we're guaranteed the manufacturer has been added
          // man_cursor points to our manufacturer so now we need to add the game
+         game_cursor = add_game(desc, mame, clone);
+         total++;
+         g_entry = findentry(&table, man_cursor, mame);
+         game_root = (g_node *)g_entry->node;
          if  (strcmp(clone, mame) == 0)                  // original game to add
          {
-            game_cursor = add_game(desc, mame, clone);
             // check a clone hasn't been added as a parent
-            game_root = findparentgame(man_cursor->firstgame, mame);
             if (game_root)
             {
                game_cursor->nclone = game_root;          // point new record's clone field to the clone
@@ -264,52 +459,44 @@ m_node* createlist()
                game_root->next = NULL;
                game_cursor->prev = game_root->prev;
                game_root->prev = NULL;
-            }
-            else
-            {
-               game_root = man_cursor->firstgame;
-               if (game_root == NULL)
-                  man_cursor->firstgame = game_cursor;   // this is the first item
-               else
-               {
-                  game_last = gotolastgame(game_root);
-                  game_last->next = game_cursor;         // previous last->next = this record
-                  game_cursor->prev = game_last;         // prev points to former last record
-               }
+
+               if (m_entry->last == game_root)
+                  m_entry->last = game_cursor;           // it was the last game, now we are
+               g_entry->node = game_cursor;              // the last clone stays the same
+               g_entry->name = game_cursor->parent;
+               continue;
             }
          }
          else  // add a clone
          {
-            game_cursor = add_game(desc, mame, clone);
-            game_root = findparentgame(man_cursor->firstgame, mame);
             if (game_root)                               // check if parent is already added
             {
-               // game_cursor now points to the parent game of this clone
-               game_last = gotolastclone(game_root);
-               if (game_last)
-               {
-                  game_last->nclone = game_cursor;       // former last rec now points to this as next
-                  game_cursor->pclone = game_last;       // new game previous clone points to former last entry
-               }
-            }
-            else
-            {
-               game_root = man_cursor->firstgame;
-               if (game_root == NULL)
-               {
-                  man_cursor->firstgame = game_cursor;   // this is the first item
-               }
-               else
-               {
-                  game_last = gotolastgame(game_root);
-                  game_last->next = game_cursor;         // previous last->next = this record
-                  game_cursor->prev = game_last;         // prev points to former last record
-               }
+               // the parent's last clone is kept in its entry
+               g_entry->last->nclone = game_cursor;      // former last rec now points to this as next
+               game_cursor->pclone = g_entry->last;      // new game previous clone points to former last entry
+               g_entry->last = game_cursor;
+               continue;
             }
          }
+
+         // a new game at the top of the list, either an original or
+         // a clone whose parent hasn't been added (yet)
+         if (m_entry->last == NULL)
+            man_cursor->firstgame = game_cursor;         // this is the first item
+         else
+         {
+            m_entry->last->next = game_cursor;           // previous last->next = this record
+            game_cursor->prev = m_entry->last;           // prev points to former last record
+         }
+         m_entry->last = game_cursor;
+         g_entry->node = game_cursor;
+         g_entry->name = game_cursor->parent;
+         g_entry->last = game_cursor;
+         table.count++;
       }
    }
    fclose(fp);
+   free(table.entries);
+   indexlist(man_root, total);
    return man_root;
 }
-
@@ -11,6 +11,8 @@ typedef struct gamenode
 {
    struct gamenode   *next, *prev;
    struct gamenode   *nclone, *pclone;
+   struct gamenode   **clones;      // the clones in order, from nclone on (set for games at the top of the list)
+   int               numclones;
    char              name[60];
    char              parent[128];
    char              clone[128];
@@ -21,6 +23,9 @@ typedef struct manufnode
    struct manufnode  *nmanuf;
    struct manufnode  *pmanuf;
    struct gamenode   *firstgame;
+   struct gamenode   **games;       // the games in order, from firstgame on
+   int               numgames;
+   int               first;         // number of games and clones in the manufacturers before this one
    char              name[30];
 } m_node;
 
@@ -36,5 +41,6 @@ g_node*  add_game(char*, char*, char*);
 g_node*  gotolastgame(g_node*);
 g_node*  gotolastclone(g_node*);
 g_node*  findparentgame(g_node*, char*);
+g_node*  nthgame(int);
 
 #endif
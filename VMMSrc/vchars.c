@@ -7,6 +7,7 @@
 *****************************************************************************/
 
 //#include <stdio.h>
+#include <stddef.h>
 #include "vchars.h"
 
 
@@ -505,6 +506,8 @@ vShape fnGetChar(char cEncode)
       c.size = 0;
       break;
    }
+   c.runs = NULL;
+   c.nruns = 0;
    return c;
 }
 
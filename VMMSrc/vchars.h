@@ -9,9 +9,18 @@ Pass it a character, receive an array and size
 #ifndef _VCHARS_H_
 #define _VCHARS_H_
 
+// A change of colour along a shape's outline
+typedef struct {
+   int start;                    // vector the run starts at, counting from 0
+   int colour;                   // colour from there on, -1 for the object's own
+   int bright;                   // brightness from there on, -1 for the object's own
+} vRun;
+
 typedef struct {
    int *array;
    int size;
+   const vRun *runs;             // colour changes in order along the outline, NULL if there are none
+   int nruns;
 } vShape;
 
 vShape   fnGetChar(char);                    // point to array for given character
@@ -0,0 +1,124 @@
+/******************************************************************
+* Vector Mame Menu - Packed fonts
+*
+* The fonts in hershey_font.c and vmmenu_font.c store each glyph
+* as a fixed size list of points, mostly padding, with -1,-1 pen
+* ups between the strokes. Drawing straight from those means
+* checking every point for a pen up and centring every y.
+*
+* The first time a font is used it is packed into one list of
+* points already centred, joined into polylines with a pen up
+* only between one polyline and the next, and an index giving
+* the first point and point count of each glyph. The glyph
+* widths are kept separately.
+*
+* Each glyph is packed once for every simplification level, so
+* small text can be drawn with fewer vectors in its curves.
+*
+*******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "vfont.h"
+#include "hershey_font.h"
+
+#define GLYPH_MID    11          // half the height of a character, y is centred on this
+#define GLYPH_POINTS 55          // most points a glyph can have
+
+static v_font  fonts[2];
+static int     packed[2] = {0, 0};
+
+
+/******************************************************************
+   Pack a font's glyphs into one list of polylines. Strokes are
+   drawn between each pair of points that isn't a pen up, and
+   simplified for each level after the first, then joined up
+   again where one ends at the start of the next.
+*******************************************************************/
+static void pack(v_font *font, const hershey_char_t *glyphs)
+{
+   int   g, i, l, n = 0, strokes, vectors;
+   int   full[GLYPH_POINTS*4], simple[GLYPH_POINTS*4], strip[GLYPH_POINTS*6];
+   const hershey_char_t *f;
+   v_vertex *p;
+
+   for (g = 0; g < VFONT_GLYPHS; g++)
+   {
+      f = &glyphs[g];
+      for (i = 1; i < f->count; i++)
+      {
+         if ((f->points[i*2 - 2] != -1) && (f->points[i*2] != -1)) n++;
+      }
+   }
+   font->points = malloc(n * 3 * VSIMP_LEVELS * sizeof(v_vertex));   // at most 3 points a stroke, at every level
+   n = 0;
+   for (g = 0; g < VFONT_GLYPHS; g++)
+   {
+      f = &glyphs[g];
+      font->width[g] = f->width;
+      strokes = 0;
+      for (i = 1; i < f->count; i++)
+      {
+         if ((f->points[i*2 - 2] != -1) && (f->points[i*2] != -1))
+         {
+            full[strokes*4 + 0] = f->points[i*2 - 2];
+            full[strokes*4 + 1] = f->points[i*2 - 1] - GLYPH_MID;
+            full[strokes*4 + 2] = f->points[i*2 + 0];
+            full[strokes*4 + 3] = f->points[i*2 + 1] - GLYPH_MID;
+            strokes++;
+         }
+      }
+      for (l = 0; l < VSIMP_LEVELS; l++)
+      {
+         font->first[l][g]   = n;
+         font->count[l][g]   = 0;
+         font->vectors[l][g] = 0;
+         if (font->points == NULL) continue;
+         vectors = vsimp_segments(full, strokes, simple, vsimp_tol[l]);
+         font->vectors[l][g] = vectors;
+         font->count[l][g]   = vsimp_strips(simple, vectors, strip, VFONT_PENUP);
+         for (i = 0; i < font->count[l][g]; i++)
+         {
+            p = &font->points[n++];
+            p->x = strip[i*2];
+            p->y = strip[i*2 + 1];
+         }
+      }
+   }
+   p = realloc(font->points, (n ? n : 1) * sizeof(v_vertex));   // give back what joining and simplifying saved
+   if (p) font->points = p;
+}
+
+
+/******************************************************************
+   Return a packed font, 1 for the Hershey font, otherwise the
+   vector font. If there's no memory to pack it the glyphs have
+   no strokes, so text is laid out but not drawn.
+*******************************************************************/
+const v_font* vfont_get(int font)
+{
+   font = (font == 1) ? 1 : 0;
+   if (!packed[font])
+   {
+      pack(&fonts[font], font ? hershey_simplex : vector_simplex);
+      packed[font] = 1;
+   }
+   return &fonts[font];
+}
+
+
+/******************************************************************
+   Lay out a string, giving the unscaled offset of each character
+   from the start of the string in xoff (if not NULL), a running
+   total of the widths before it. Returns the width of the string.
+*******************************************************************/
+int vfont_layout(const char *text, const v_font *font, int *xoff)
+{
+   int c, x = 0;
+   for (c = 0; text[c]; c++)
+   {
+      if (xoff) xoff[c] = x;
+      x += font->width[VFONT_GLYPH(text[c])];
+   }
+   return x;
+}
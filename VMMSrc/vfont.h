@@ -0,0 +1,38 @@
+/**************************************
+vfont.h
+Packed fonts, the Hershey and vector
+fonts as one list of polylines per font
+Function declarations
+**************************************/
+
+#ifndef _VFONT_H_
+#define _VFONT_H_
+
+#include <stdint.h>
+#include "vsimp.h"
+
+#define VFONT_GLYPHS 95          // ' ' to '~'
+
+// Index of the glyph for character c, anything without one prints as a space
+#define VFONT_GLYPH(c)  ((((unsigned char)(c) - ' ') < VFONT_GLYPHS) ? ((unsigned char)(c) - ' ') : 0)
+
+#define VFONT_PENUP  (-128)     // x of a point that lifts the pen
+
+typedef struct
+{
+   int8_t   x, y;                // y centred on the middle of the character
+} v_vertex;
+
+typedef struct
+{
+   v_vertex *points;             // every glyph's polylines at each level, one glyph after another
+   uint16_t first[VSIMP_LEVELS][VFONT_GLYPHS];    // each glyph's first point, at each simplification level
+   uint8_t  count[VSIMP_LEVELS][VFONT_GLYPHS];    // and how many it has, pen ups included
+   uint8_t  vectors[VSIMP_LEVELS][VFONT_GLYPHS];  // vectors drawn through them
+   uint8_t  width[VFONT_GLYPHS]; // width of each glyph, unscaled
+} v_font;
+
+const v_font* vfont_get(int);                         // packed font, 1 = Hershey, else the vector font
+int           vfont_layout(const char*, const v_font*, int*);   // offset of each character, returns the total width
+
+#endif
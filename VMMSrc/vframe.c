@@ -0,0 +1,628 @@
+/******************************************************************
+* Vector Mame Menu - Frame vector list
+*
+* Collects the vectors (and their colours) drawn during a frame so
+* they can be reordered before being handed to the ZVG/DVG driver.
+* Vectors are chained so that each one starts as close as possible
+* to where the previous one ended, which cuts the blanked beam
+* travel between them. Vectors may be drawn in either direction.
+*
+* Vectors are only reordered within runs of the same colour, so
+* the optimiser never adds colour changes to a frame.
+*
+* Colour grouping gathers all the vectors of each colour into one
+* run, so each colour (and the settling time the monitor needs
+* when the colour changes) only comes up once per frame. Colours
+* keep the order they first appeared in, and vectors keep their
+* order within a colour.
+*
+* With both off, vectors go to the driver in the order they were
+* drawn.
+*
+* Everything drawn in a frame is also kept as a list of the calls
+* made, which is compared with the last frame's. When nothing has
+* changed, as in most frames while the menu sits idle, the driver
+* repeats the frame it already has (see zvgFrameRepeat()) and the
+* frame isn't optimised or encoded at all. A frame that has changed
+* is built in full, the drivers carry the beam position and colour
+* from one vector to the next so there is no picking out the parts
+* of it that differ.
+*
+*******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "vframe.h"
+#include "zvgFrame.h"
+
+#define OPT_CHUNK    256         // longest run of vectors optimised in one go
+#define OPT_PASSES   4           // maximum number of 2-opt passes over a chunk
+#define RGB15(r, g, b)  (((r) << 10) | ((g) << 5) | (b))
+#define PASSTHROUGH     ((beammode == BEAM_OFF) && (groupmode == GROUP_OFF))
+
+// Calls kept in the frame's list, each followed by its arguments
+#define REC_COLOUR   0           // r, g, b
+#define REC_VECTOR   1           // x1, y1, x2, y2
+#define REC_STRIP    2           // n, then n x,y pairs
+
+static v_seg   *segs = NULL;
+static v_seg   *sorted = NULL;            // segs gathered by colour
+static vec_t   *batch = NULL;             // one colour run, ready for zvgFrameVectors()
+static int     segcount = 0, segsize = 0;
+static int     beammode = BEAM_OFF;
+static int     groupmode = GROUP_OFF;
+static int     colslot[32768];            // RGB15 colour to its slot in the frame, or 0
+static int     cur_r = 0, cur_g = 0, cur_b = 0;
+static int     *rec = NULL, *prev = NULL;  // this frame's calls, and the last frame's
+static int     reccount = 0, recsize = 0;
+static int     prevcount = 0, prevsize = 0;
+static int     recrgb = 0, prevrgb = 0;   // RGB15 colour set when each frame started
+static int     prevvalid = 0;             // prev holds a whole frame, as sent
+static int     direct = 0;                // out of memory, the rest of the frame goes straight to the driver
+static v_stats totals;
+
+
+/******************************************************************
+   Distance the beam travels between two points. Both axes are
+   deflected at once, so it's the larger of the two that counts.
+*******************************************************************/
+static int beamdist(int x1, int y1, int x2, int y2)
+{
+   int dx = abs(x2 - x1);
+   int dy = abs(y2 - y1);
+   return (dx > dy) ? dx : dy;
+}
+
+
+/******************************************************************
+   Swap the start and end points of a vector
+*******************************************************************/
+static void flipseg(v_seg *s)
+{
+   int t;
+   t = s->x1; s->x1 = s->x2; s->x2 = t;
+   t = s->y1; s->y1 = s->y2; s->y2 = t;
+}
+
+
+/******************************************************************
+   Work out the blanked travel and the number of commands needed
+   to send a list of vectors in the given order
+*******************************************************************/
+static void measure(v_seg *s, int n, double *blank, unsigned int *cmds)
+{
+   int i, x = INT_MIN, y = INT_MIN, r = -1, g = -1, b = -1;
+   for (i = 0; i < n; i++)
+   {
+      if ((s[i].r != r) || (s[i].g != g) || (s[i].b != b))
+      {
+         (*cmds)++;                          // colour change
+         r = s[i].r;
+         g = s[i].g;
+         b = s[i].b;
+      }
+      if ((s[i].x1 != x) || (s[i].y1 != y))
+      {
+         (*cmds)++;                          // blank move to the start
+         if (x != INT_MIN) *blank += beamdist(x, y, s[i].x1, s[i].y1);
+      }
+      (*cmds)++;                             // the vector itself
+      x = s[i].x2;
+      y = s[i].y2;
+   }
+}
+
+
+/******************************************************************
+   Greedy chaining - repeatedly pick whichever remaining vector has
+   an end nearest the beam, flipping it if need be
+*******************************************************************/
+static void greedy(v_seg *s, int n, int *bx, int *by)
+{
+   int   i, j, best, d, d1, d2, flip;
+   v_seg t;
+
+   for (i = 0; i < n; i++)
+   {
+      if (*bx != INT_MIN)
+      {
+         best = i;
+         flip = 0;
+         d    = INT_MAX;
+         for (j = i; j < n && d; j++)
+         {
+            d1 = beamdist(*bx, *by, s[j].x1, s[j].y1);
+            d2 = beamdist(*bx, *by, s[j].x2, s[j].y2);
+            if (d1 < d)
+            {
+               d = d1;
+               best = j;
+               flip = 0;
+            }
+            if (d2 < d)
+            {
+               d = d2;
+               best = j;
+               flip = 1;
+            }
+         }
+         t = s[i];
+         s[i] = s[best];
+         s[best] = t;
+         if (flip) flipseg(&s[i]);
+      }
+      *bx = s[i].x2;
+      *by = s[i].y2;
+   }
+}
+
+
+/******************************************************************
+   2-opt improvement - reverse any stretch of vectors (and the
+   direction of each) where that shortens the blank moves at its
+   two ends
+*******************************************************************/
+static void twoopt(v_seg *s, int n, int bx, int by)
+{
+   int   pass, i, j, k, px, py, improved, oldcost, newcost;
+   v_seg t;
+
+   for (pass = 0; pass < OPT_PASSES; pass++)
+   {
+      improved = 0;
+      for (i = 0; i < n - 1; i++)
+      {
+         px = i ? s[i - 1].x2 : bx;
+         py = i ? s[i - 1].y2 : by;
+         for (j = i + 1; j < n; j++)
+         {
+            oldcost = 0;
+            newcost = 0;
+            if (px != INT_MIN)
+            {
+               oldcost += beamdist(px, py, s[i].x1, s[i].y1);
+               newcost += beamdist(px, py, s[j].x2, s[j].y2);
+            }
+            if (j < n - 1)
+            {
+               oldcost += beamdist(s[j].x2, s[j].y2, s[j + 1].x1, s[j + 1].y1);
+               newcost += beamdist(s[i].x1, s[i].y1, s[j + 1].x1, s[j + 1].y1);
+            }
+            if (newcost < oldcost)
+            {
+               for (k = 0; k < (j - i + 1) / 2; k++)
+               {
+                  t = s[i + k];
+                  s[i + k] = s[j - k];
+                  s[j - k] = t;
+               }
+               for (k = i; k <= j; k++)
+               {
+                  flipseg(&s[k]);
+               }
+               improved = 1;
+            }
+         }
+      }
+      if (!improved) break;
+   }
+}
+
+
+/******************************************************************
+   Gather the frame's vectors by colour, using a counting sort so
+   it's stable and takes linear time
+*******************************************************************/
+static void group(void)
+{
+   int   i, c, colours = 0;
+   int   start[257];
+   int   used[256];
+   v_seg *t;
+
+   for (i = 0; i < segcount; i++)
+   {
+      c = RGB15(segs[i].r, segs[i].g, segs[i].b);
+      if (colslot[c] == 0)
+      {
+         if (colours == 256)
+         {
+            break;                  // far too many colours to bother
+         }
+         used[colours++] = c;
+         colslot[c] = colours;      // slot + 1, so 0 means unused
+      }
+   }
+   if ((i == segcount) && (colours > 1))
+   {
+      memset(start, 0, sizeof(start));
+      for (i = 0; i < segcount; i++)
+      {
+         start[colslot[RGB15(segs[i].r, segs[i].g, segs[i].b)]]++;
+      }
+      for (i = 1; i <= colours; i++)
+      {
+         start[i] += start[i - 1];
+      }
+      for (i = 0; i < segcount; i++)
+      {
+         c = colslot[RGB15(segs[i].r, segs[i].g, segs[i].b)] - 1;
+         sorted[start[c]++] = segs[i];
+      }
+      t = segs;
+      segs = sorted;
+      sorted = t;
+   }
+   for (i = 0; i < colours; i++)
+   {
+      colslot[used[i]] = 0;
+   }
+}
+
+
+/******************************************************************
+   Make room for n more ints in the frame's list of calls, returns
+   where they go, or NULL if there's no memory for them
+*******************************************************************/
+static int* recroom(int n)
+{
+   int   *r, size;
+   if (reccount + n > recsize)
+   {
+      size = recsize ? recsize : 4096;
+      while (size < reccount + n)
+      {
+         size *= 2;
+      }
+      r = realloc(rec, size * sizeof(int));
+      if (r == NULL)
+      {
+         return NULL;
+      }
+      rec = r;
+      recsize = size;
+   }
+   r = &rec[reccount];
+   reccount += n;
+   return r;
+}
+
+
+/******************************************************************
+   Make room for one more vector to be optimised, returns 0 if
+   there's no memory for it
+*******************************************************************/
+static int segroom(void)
+{
+   v_seg *s, *t;
+   vec_t *v;
+   if (segcount < segsize) return 1;
+   segsize = segsize ? segsize * 2 : 1024;
+   s = realloc(segs, segsize * sizeof(v_seg));
+   if (s != NULL)
+   {
+      segs = s;
+   }
+   t = realloc(sorted, segsize * sizeof(v_seg));
+   if (t != NULL)
+   {
+      sorted = t;
+   }
+   v = realloc(batch, segsize * sizeof(vec_t));
+   if (v != NULL)
+   {
+      batch = v;
+   }
+   if ((s == NULL) || (t == NULL) || (v == NULL))
+   {
+      segsize = segcount;
+      return 0;
+   }
+   return 1;
+}
+
+
+/******************************************************************
+   Pass a list of calls on to the driver
+*******************************************************************/
+static void replay(const int *r, int n)
+{
+   int i = 0;
+   while (i < n)
+   {
+      switch (r[i])
+      {
+         case REC_COLOUR:
+            zvgFrameSetRGB15(r[i + 1], r[i + 2], r[i + 3]);
+            i += 4;
+            break;
+         case REC_VECTOR:
+            zvgFrameVector(r[i + 1], r[i + 2], r[i + 3], r[i + 4]);
+            i += 5;
+            break;
+         default:
+            zvgFrameStrip(&r[i + 2], r[i + 1]);
+            i += 2 + r[i + 1] * 2;
+            break;
+      }
+   }
+}
+
+
+/******************************************************************
+   Optimise the order of the vectors held in segs and send them to
+   the driver
+*******************************************************************/
+static void sendsegs(void)
+{
+   int   start, end, i, bx = INT_MIN, by = INT_MIN;
+
+   if (segcount == 0) return;
+
+   measure(segs, segcount, &totals.blank_before, &totals.cmds_before);
+
+   if (groupmode == GROUP_COLOUR)
+   {
+      group();
+   }
+
+   // Optimise each run of one colour, in chunks to bound the work
+   if (beammode != BEAM_OFF)
+   {
+      for (start = 0; start < segcount; start = end)
+      {
+         end = start + 1;
+         while ((end < segcount) && (end - start < OPT_CHUNK) && (segs[end].r == segs[start].r)
+                  && (segs[end].g == segs[start].g) && (segs[end].b == segs[start].b))
+         {
+            end++;
+         }
+         greedy(&segs[start], end - start, &bx, &by);
+         if (beammode == BEAM_2OPT)
+         {
+            twoopt(&segs[start], end - start, start ? segs[start - 1].x2 : INT_MIN, start ? segs[start - 1].y2 : INT_MIN);
+            bx = segs[end - 1].x2;
+            by = segs[end - 1].y2;
+         }
+      }
+   }
+
+   measure(segs, segcount, &totals.blank_after, &totals.cmds_after);
+   totals.frames++;
+   totals.vectors += segcount;
+
+   // Send each colour run as one batch
+   for (start = 0; start < segcount; start = end)
+   {
+      zvgFrameSetRGB15(segs[start].r, segs[start].g, segs[start].b);
+      for (end = start; end < segcount; end++)
+      {
+         if ((segs[end].r != segs[start].r) || (segs[end].g != segs[start].g) || (segs[end].b != segs[start].b))
+         {
+            break;
+         }
+         i = end - start;
+         batch[i].xStart = segs[end].x1;
+         batch[i].yStart = segs[end].y1;
+         batch[i].xEnd   = segs[end].x2;
+         batch[i].yEnd   = segs[end].y2;
+      }
+      zvgFrameVectors(batch, end - start);
+   }
+   segcount = 0;
+}
+
+
+/******************************************************************
+   Out of memory. Send what there is of the frame so far, and send
+   the rest of it straight to the driver as it's drawn.
+*******************************************************************/
+static void godirect(void)
+{
+   if (PASSTHROUGH)
+   {
+      replay(rec, reccount);
+   }
+   else
+   {
+      sendsegs();
+   }
+   zvgFrameSetRGB15(cur_r, cur_g, cur_b);
+   direct = 1;
+}
+
+
+/******************************************************************
+   Select the beam path optimisation mode
+*******************************************************************/
+void vframe_mode(int mode)
+{
+   if ((mode < BEAM_OFF) || (mode > BEAM_2OPT)) mode = BEAM_OFF;
+   beammode = mode;
+   prevvalid = 0;             // the next frame goes out in a different order
+}
+
+
+/******************************************************************
+   Select the colour grouping mode
+*******************************************************************/
+void vframe_group(int mode)
+{
+   if ((mode < GROUP_OFF) || (mode > GROUP_COLOUR)) mode = GROUP_OFF;
+   groupmode = mode;
+   prevvalid = 0;
+}
+
+
+/******************************************************************
+   Set the colour of the vectors that follow (RGB15, 0-31 each)
+*******************************************************************/
+void vframe_colour(int r, int g, int b)
+{
+   int *c;
+   cur_r = r;
+   cur_g = g;
+   cur_b = b;
+   if (!direct)
+   {
+      c = recroom(4);
+      if (c != NULL)
+      {
+         c[0] = REC_COLOUR;
+         c[1] = r;
+         c[2] = g;
+         c[3] = b;
+         return;
+      }
+      godirect();
+   }
+   zvgFrameSetRGB15(r, g, b);
+}
+
+
+/******************************************************************
+   Add a vector to the frame
+*******************************************************************/
+void vframe_vector(int x1, int y1, int x2, int y2)
+{
+   int   *c;
+   v_seg *s;
+   if (!direct)
+   {
+      if (PASSTHROUGH || segroom())
+      {
+         c = recroom(5);
+      }
+      else
+      {
+         c = NULL;
+      }
+      if (c == NULL)
+      {
+         godirect();
+      }
+   }
+   if (direct)
+   {
+      zvgFrameVector(x1, y1, x2, y2);
+      return;
+   }
+   c[0] = REC_VECTOR;
+   c[1] = x1;
+   c[2] = y1;
+   c[3] = x2;
+   c[4] = y2;
+   if (PASSTHROUGH) return;
+   s = &segs[segcount++];
+   s->x1 = x1;
+   s->y1 = y1;
+   s->x2 = x2;
+   s->y2 = y2;
+   s->r  = cur_r;
+   s->g  = cur_g;
+   s->b  = cur_b;
+}
+
+
+/******************************************************************
+   Add a strip of joined vectors through n points, given as x,y
+   pairs. Unless the frame is being reordered the strip goes to
+   the driver in one go, otherwise its vectors are added one by
+   one like any others.
+*******************************************************************/
+void vframe_strip(const int *xy, int n)
+{
+   int i, *c;
+   if (PASSTHROUGH && !direct)
+   {
+      c = recroom(2 + n * 2);
+      if (c != NULL)
+      {
+         c[0] = REC_STRIP;
+         c[1] = n;
+         memcpy(&c[2], xy, n * 2 * sizeof(int));
+         return;
+      }
+      godirect();
+   }
+   if (direct)
+   {
+      zvgFrameStrip(xy, n);
+      return;
+   }
+   for (i = 1; i < n; i++)
+   {
+      vframe_vector(xy[i*2 - 2], xy[i*2 - 1], xy[i*2], xy[i*2 + 1]);
+   }
+}
+
+
+/******************************************************************
+   Send the frame to the driver, optimised if need be. If it's the
+   same as the last frame the driver repeats that one instead, and
+   the frame isn't sent at all. Must be called before zvgFrameSend().
+*******************************************************************/
+void vframe_flush(void)
+{
+   int   *t, i, same;
+
+   same = prevvalid && !direct && (reccount == prevcount) && (recrgb == prevrgb)
+            && ((reccount == 0) || (memcmp(rec, prev, reccount * sizeof(int)) == 0));
+
+   // This frame's calls become the last frame's
+   t = prev;
+   prev = rec;
+   rec = t;
+   i = prevsize;
+   prevsize = recsize;
+   recsize = i;
+   prevcount = reccount;
+   prevrgb   = recrgb;
+   prevvalid = !direct;
+   reccount  = 0;
+   recrgb    = RGB15(cur_r, cur_g, cur_b);
+
+   if (direct)
+   {
+      direct = 0;             // it has all been sent already
+   }
+   else if (same && zvgFrameRepeat())
+   {
+      segcount = 0;
+   }
+   else if (PASSTHROUGH)
+   {
+      replay(prev, prevcount);
+   }
+   else
+   {
+      sendsegs();
+   }
+}
+
+
+/******************************************************************
+   Return the totals collected since startup
+*******************************************************************/
+void vframe_stats(v_stats *stats)
+{
+   *stats = totals;
+}
+
+
+/******************************************************************
+   Print a before/after summary of the beam path optimisation
+*******************************************************************/
+void vframe_report(void)
+{
+   double f;
+   if (totals.frames == 0) return;
+   f = totals.frames;
+   printf("Beam path optimiser (%s%s), %u frames, %.0f vectors/frame\n",
+      (beammode == BEAM_2OPT) ? "2-opt" : (beammode == BEAM_GREEDY) ? "greedy" : "off",
+      (groupmode == GROUP_COLOUR) ? ", grouped by colour" : "", totals.frames, totals.vectors / f);
+   printf("   Blank travel/frame: %.0f before, %.0f after\n", totals.blank_before / f, totals.blank_after / f);
+   printf("   Commands/frame:     %.0f before, %.0f after\n", totals.cmds_before / f, totals.cmds_after / f);
+}
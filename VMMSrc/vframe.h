@@ -0,0 +1,45 @@
+/**************************************
+vframe.h
+Frame vector list, collects a frame's
+vectors before they go to the ZVG/DVG
+Function declarations
+**************************************/
+
+#ifndef _VFRAME_H_
+#define _VFRAME_H_
+
+// Beam path optimisation modes (interface:beamopt in vmmenu.cfg)
+#define BEAM_OFF     0           // send vectors in the order they were drawn
+#define BEAM_GREEDY  1           // chain each vector to the nearest remaining one
+#define BEAM_2OPT    2           // greedy, then improve with 2-opt reversals
+
+typedef struct
+{
+   int   x1, y1, x2, y2;
+   int   r, g, b;                // RGB15 colour the vector was drawn in
+} v_seg;
+
+// Colour grouping modes (interface:colourgroup in vmmenu.cfg)
+#define GROUP_OFF    0           // keep vectors in colour order as drawn
+#define GROUP_COLOUR 1           // gather vectors of each colour together
+
+typedef struct
+{
+   unsigned int   frames;        // frames measured
+   unsigned int   vectors;       // vectors drawn
+   double         blank_before;  // blanked beam travel in submission order
+   double         blank_after;   // blanked beam travel as sent
+   unsigned int   cmds_before;   // colour + blank move + draw commands in submission order
+   unsigned int   cmds_after;    // the same, as sent
+} v_stats;
+
+void  vframe_mode(int);                      // select a beam path optimisation mode
+void  vframe_group(int);                     // select a colour grouping mode
+void  vframe_colour(int, int, int);          // set the RGB15 colour of following vectors
+void  vframe_vector(int, int, int, int);     // add a vector to the frame
+void  vframe_strip(const int*, int);         // add a strip of joined vectors through points given as x,y pairs
+void  vframe_flush(void);                    // optimise and send the frame's vectors to the driver, or repeat the last frame
+void  vframe_stats(v_stats*);                // totals since startup
+void  vframe_report(void);                   // print the before/after totals
+
+#endif
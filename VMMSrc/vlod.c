@@ -0,0 +1,156 @@
+/******************************************************************
+* Vector Mame Menu - Detail level
+*
+* Keeps a budget of how many vectors a frame can have and still be
+* sent before the next one is due, and drops detail from the menu
+* when frames go over it.
+*
+* The budget comes from the driver. When a frame has to wait for
+* the one before it to finish going out, that frame's vectors took
+* a frame plus the wait to send, which gives the rate the vector
+* generator is really taking them at. A frame too big for the
+* driver at all sets the budget to less than that frame. While
+* frames go out without waiting the budget creeps back up.
+*
+* Going over the budget for a few frames in a row drops one level
+* of detail. A level is given back once the vectors it drew last
+* time have fitted the budget for a couple of seconds. If it has
+* to be dropped again soon after, it waits twice as long before
+* trying again, so a VG that is only just too slow isn't given a
+* level back every few seconds.
+*
+*******************************************************************/
+
+#include <stdio.h>
+#include "vlod.h"
+#include "zvgFrame.h"
+#if !(defined(linux) || defined(__linux) || defined(__WIN32__) || defined(_WIN32))
+   #include "vmmstddef.h"
+   #include "DOSvmm.h"                 // the DOS SDK has no stats, DOSvmm.c stands in
+#endif
+
+#define HEADROOM     0.9         // fraction of the measured rate the budget allows
+#define OVER_FRAMES  3           // frames over budget before detail is dropped
+#define UNDER_FRAMES 120         // frames a level must fit before it is given back
+#define MAX_HOLD     7200        // longest the wait to give a level back can grow to
+#define SETTLE       600         // frames after giving a level back that dropping it counts as too soon
+#define CREEP        1000        // the budget grows by 1/CREEP a frame when nothing waits
+#define MAX_BUDGET   100000.0    // vectors a frame, no need to count any higher
+
+static int           level = LOD_FULL, lowest = LOD_FULL;
+static int           fps = 60;
+static double        budget = 0;             // vectors a frame, 0 until the VG has been seen to fall behind
+static int           lastvectors = 0;
+static int           used[LOD_LEVELS];       // vectors drawn at each level, last time it was used
+static int           over = 0, under = 0;    // frames in a row over budget, and with a level to spare
+static int           hold = UNDER_FRAMES;    // frames a level must fit before it is given back
+static unsigned int  frame = 0, restored = 0;   // frames counted, and when a level was last given back
+static unsigned int  stallframes = 0, stallms = 0, overframes = 0, overbytes = 0;
+static unsigned int  changes = 0;
+static const char    *names[LOD_LEVELS] = {"full", "no stars", "fewer asteroids", "simple font", "fewer rows"};
+
+
+/******************************************************************
+   Change detail level
+*******************************************************************/
+static void setlevel(int l)
+{
+   if (l < level)
+   {
+      restored = frame;
+   }
+   else if (restored && (frame - restored < SETTLE))
+   {
+      if (hold < MAX_HOLD) hold *= 2;        // too soon, wait longer next time
+   }
+   level = l;
+   if (level > lowest) lowest = level;
+   over  = 0;
+   under = 0;
+   changes++;
+}
+
+
+/******************************************************************
+   Start measuring, at fps frames a second. Driver totals from
+   before now are not counted.
+*******************************************************************/
+void vlod_init(int rate)
+{
+   if (rate > 0) fps = rate;
+   zvgFrameStallStats(&stallframes, &stallms);
+   zvgFrameOverflowStats(&overframes, &overbytes);
+}
+
+
+/******************************************************************
+   Called after each frame is sent, with the number of vectors in
+   it. Updates the budget and the detail level.
+*******************************************************************/
+void vlod_frame(int vectors)
+{
+   unsigned int   frames, ms, oframes, obytes;
+   double         period = 1000.0 / fps;
+
+   zvgFrameStallStats(&frames, &ms);
+   zvgFrameOverflowStats(&oframes, &obytes);
+   if (oframes != overframes)
+   {
+      budget = vectors * HEADROOM;                                         // didn't fit at all
+   }
+   else if (frames != stallframes)
+   {
+      budget = lastvectors * period / (period + (ms - stallms)) * HEADROOM; // the last frame was still going out
+   }
+   else if ((budget > 0) && (budget < MAX_BUDGET))
+   {
+      budget += budget / CREEP + 1;
+   }
+   stallframes = frames;
+   stallms     = ms;
+   overframes  = oframes;
+   overbytes   = obytes;
+   lastvectors = vectors;
+   used[level] = vectors;
+   frame++;
+   if (restored && (frame - restored == SETTLE * 4)) hold = UNDER_FRAMES;   // settled, back to normal
+
+   if (budget == 0) return;
+   if (vectors > budget)
+   {
+      under = 0;
+      if ((++over >= OVER_FRAMES) && (level < LOD_LEVELS - 1)) setlevel(level + 1);
+   }
+   else
+   {
+      over = 0;
+      if ((level > LOD_FULL) && (used[level - 1] <= budget))
+      {
+         if (++under >= hold) setlevel(level - 1);
+      }
+      else
+      {
+         under = 0;
+      }
+   }
+}
+
+
+/******************************************************************
+   Return the current detail level
+*******************************************************************/
+int vlod_level(void)
+{
+   return level;
+}
+
+
+/******************************************************************
+   Print the detail level totals, if detail was ever dropped
+*******************************************************************/
+void vlod_report(void)
+{
+   if (changes == 0) return;
+   printf("Detail level: %d (%s) at exit, lowest %d (%s), changed %u times, budget %.0f vectors/frame\n",
+      level, names[level], lowest, names[lowest], changes, budget);
+}
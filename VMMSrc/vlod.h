@@ -0,0 +1,25 @@
+/**************************************
+vlod.h
+Detail level, drops detail from the
+menu when frames are more than the
+vector generator can keep up with
+Function declarations
+**************************************/
+
+#ifndef _VLOD_H_
+#define _VLOD_H_
+
+// Detail levels, each also drops what the ones before it do
+#define LOD_FULL     0           // everything drawn
+#define LOD_NOSTARS  1           // starfield not drawn
+#define LOD_FEWROCKS 2           // half the asteroids drawn
+#define LOD_SIMPLE   3           // games list in the simple vector font
+#define LOD_ROWS     4           // fewer rows on the games list
+#define LOD_LEVELS   5
+
+void  vlod_init(int);                        // start measuring, at the given frame rate
+void  vlod_frame(int);                       // a frame of this many vectors was sent
+int   vlod_level(void);                      // current detail level
+void  vlod_report(void);                     // print the detail level totals
+
+#endif
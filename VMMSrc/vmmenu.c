@@ -77,6 +77,9 @@
 * 21-Nov-20 v1.9     Added Joypad support (Mario Montminy)
 *                    Improvements to the USB-DVG driver (Mario Montminy)
 *
+* 16-Oct-26          ZVG and USB-DVG drivers no longer cut large frames short,
+*                    so the settings screens use the selected font again
+*
 ***********************************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
@@ -91,7 +94,10 @@
 #include "editlist.h"
 #include "zvgFrame.h"
 
-#include "hershey_font.h"
+#include "vfont.h"
+#include "vtext.h"
+#include "vlod.h"
+#include "vsimp.h"
 //#include "vector_font.h"
 
 //OS Specific Headers
@@ -111,11 +117,18 @@
 #define c_align   2
 #define r_align   3
 
+#define SHAPE_STRIPS  16          // shapes whose polylines are kept
+
 /****Function declarations***/
 void     PrintString(char*, int, int, int, float, float, int, int, int);   // prints a string of characters
 int      StringPixelLength(char *, float, int);                            // Calculate pixel length of a string
-point    fnrotate(int, float, float, float, float);                        // rotate a point given number of degrees
+vmatrix  mxmake(int, float, float, float, float);                         // make a rotate, scale and translate transform
+vmatrix  mxmul(vmatrix, vmatrix);                                          // combine two transforms
+point    mxapply(vmatrix*, float, float);                                  // transform a point
+vmatrix  screenmatrix(void);                                               // transform for the screen rotation
 void     drawshape(vObject);                                               // draw shape pointed to by vObject
+void     runcolour(vObject*, int);                                         // set the colour of a run of a shape's outline
+point*   shapestrip(vShape, int, int*, int*);                              // a shape's outline as polylines, simplified to a level
 vObject  updateobject(vObject);                                            // update position and rotation of a vector object
 void     drawborders(int, int, int, int, int, int, int);                   // draw borders around edge of screen
 char*    ucase(char*);                                                     // convert string to uppercase
@@ -135,6 +148,7 @@ vStar    make_star(void);                                                  // de
 vStar    updatestar(vStar);                                                // update a star object
 void     drawstar(vStar);                                                  // Draw a star
 void     showstars();                                                      // Display all the stars on screen
+int      shownasteroids(void);                                             // Number of asteroids to draw at this detail level
 void     getsettings(void);                                                // get settings from ini file
 void     writeinival(char*, int, int, int);                                // write a value to the cfg file
 void     writecfg(void);                                                   // write the cfg file to the dictionary
@@ -150,7 +164,6 @@ void     EditColours(void);                                                // Se
 void     drawbox(int, int, int, int, int, int);                            // xmin, ymin, xmax, ymax, colour, intensity
 void     TestPatterns(void);                                               // Monitor Test Patterns
 void     BrightnessBars(int, int, int, int);                               // Prints brightness bars on screen
-int      numofgames(m_node *);                                             // Count the number of games in the tree
 
 // Global variables (there are quite a few...)
 
@@ -178,6 +191,19 @@ int          ZVGPresent = 1;
 extern int   SDL_VC, SDL_VB;            // colour and brightness for SDL vectors
 int          mousefound=0;
 int          jsdeadzone=32000;          //Joystick deadzone 
+int          beamopt=0;                 // Beam path optimisation, 0:Off, 1:Greedy, 2:2-opt
+int          colourgroup=0;             // Gather each frame's vectors by colour, 0:Off, 1:On
+int          framerate=0;               // Frames per second, 0: vector generator's default
+int          benchframes=0;             // Frames to run in benchmark mode (-bench), 0 when not benchmarking
+int          autodetail=1;              // Drop detail when the vector generator can't keep up, 0:Off, 1:On
+
+static struct
+{
+   int       *array;                    // outline the polylines were made from, NULL if unused
+   point     *strip[VSIMP_LEVELS];      // the outline simplified to each level, as polylines
+   int       points[VSIMP_LEVELS];      // points in each, pen ups included
+   int       vectors[VSIMP_LEVELS];     // vectors drawn through them
+} shapestrips[SHAPE_STRIPS];
 
 m_node       *vectorgames;
 g_node       *gamelist_root = NULL, *sel_game = NULL, *sel_clone = NULL;
@@ -195,26 +221,40 @@ vObject      mame;
 ********************************************************************/
 int main(int argc, char *argv[])
 {
-   (void)       argc;
-   (void)       argv;
    unsigned int err;
    int          count, top, timeout = 0, ticks = 0, gamesize, totgames;
+   int          benchcount = 0, step;
    int          pressx=0, pressy=0;
    int          cc, gamenum, gamenumtemp;
    float        width=0.0;
+   int          redraw, drawnnum = 0, drawnlod = 0;   // what the menu layers were last drawn with
+   int          listrows = maxgamesonlist, listfont;
+   unsigned int drawnmenu = 0;
+   float        drawnwidth = 0.0;
+   m_node       *drawnman = NULL;
+   g_node       *drawnclone = NULL;
    char         mytext[100];
    int          mpx = 0, mpy = 0;
    vObject      sega, cinematronics, atari, centuri, vbeam, midway, vectrex;
    FILE         *inifp;
    char         *ini_name = "vmmenu.cfg";
 
+   // vmmenu -bench [frames] runs the menu screens from a script, sending
+   // frames as fast as the vector generator takes them, then reports timings
+   if ((argc > 1) && !strcmp(argv[1], "-bench"))
+   {
+      benchframes = (argc > 2) ? atoi(argv[2]) : 3600;
+      if (benchframes < 1) benchframes = 3600;
+      printf("Benchmark mode, running %d frames\n", benchframes);
+   }
+
    vectorgames = createlist();
    totalnumgames=printlist(vectorgames);
    linklist(vectorgames);
    sel_game = vectorgames->firstgame;
    sel_clone = sel_game;
    man_menu = 1;
-   totgames=numofgames(vectorgames);
+   totgames=vectorgames->numgames;
 
    inifp = fopen (ini_name, "r" );
    if (inifp != NULL)
@@ -314,22 +354,24 @@ int main(int argc, char *argv[])
    midway         = make_midway();
    vectrex        = make_vectrex();
 
-   if (autostart)
+   if (autostart && !benchframes)
    {
        int autostart_allowed = 1;
+       #ifdef USBDVG
        if (ZVGPresent == 2) 
        {
-            char value[64];
+            const dvg_caps_t *caps = zvgGetCaps();
             // Override with game chosen on USB-DVG.
-            if (0){//zvgGetOption("defaultGame", value, sizeof(value)) == 0) {
-                if (!strcmp(value, "none")) {
+            if (caps->have & DVG_HAVE_DEFAULTGAME) {
+                if (!strcmp(caps->defaultGame, "none")) {
                     autostart_allowed = 0;
                 }
-                else {
-                    strncpy(autogame, value, sizeof(autogame) - 1);
+                else if (strlen(caps->defaultGame) < sizeof(autogame)) {
+                    strcpy(autogame, caps->defaultGame);    // a name too long to be a game is ignored
                 }
             }
         }
+       #endif
         if (autostart_allowed) 
         {
             printf("\nAutostart configured to run \"%s\"...\n", autogame);
@@ -348,8 +390,27 @@ int main(int argc, char *argv[])
 
       cc=getkey();                              // Check keys and mouse movement
 
+      // In benchmark mode the script takes over from the controls. Every
+      // 600 frames it steps through the manufacturers, scrolls down the
+      // game list, then sits in the screensaver.
+      if (benchframes)
+      {
+         if (benchcount++ >= benchframes) break;
+         step = benchcount % 600;
+         cc   = 0;
+         if (step == 0)
+         {
+            timeout  = 0;
+            man_menu = 1;
+         }
+         if ((step < 200) && (step % 20 == 19))    cc = keyz[k_nman];
+         if ((step >= 200) && (step < 400) && (step % 10 == 0)) cc = keyz[k_ngame];
+         if (step == 400)                          timeout = 1801;
+      }
+
       if (timeout > 1800)      // ############## screensaver mode 1800 * 1/60 = 30 seconds ##############
       {
+         drawnman = NULL;                                                  // draw the whole menu when it's back
          if ((ticks%360) == 0)   setLEDs(0);
          if ((ticks%360) == 60)  setLEDs(S_LED);
          if ((ticks%360) == 120) setLEDs(S_LED | N_LED);
@@ -359,7 +420,7 @@ int main(int argc, char *argv[])
 
          for (count=0; count < NUM_ASTEROIDS; count++)
          {
-            drawshape(asteroid[count]);
+            if (count < shownasteroids()) drawshape(asteroid[count]);
             asteroid[count] = updateobject(asteroid[count]);
          }
          drawshape(mame);
@@ -417,6 +478,7 @@ int main(int argc, char *argv[])
             {
                SetOptions();                                               // Go to Settings page
                gamenum     = 1;
+               totgames    = vectorgames->numgames;                        // the list may have been edited
                sel_game    = vectorgames->firstgame;
                sel_clone   = sel_game;
                man_menu    = 1;
@@ -437,7 +499,7 @@ int main(int argc, char *argv[])
                   sel_game = vectorgames->firstgame;
                   sel_clone = sel_game;
                   gamenum=1;
-                  totgames=numofgames(vectorgames);
+                  totgames=vectorgames->numgames;
                }
                if (cc == keyz[k_nman])                                     // [Right]: Go to next manufacturer
                {
@@ -445,7 +507,7 @@ int main(int argc, char *argv[])
                   sel_game = vectorgames->firstgame;
                   sel_clone = sel_game;
                   gamenum=1;
-                  totgames=numofgames(vectorgames);
+                  totgames=vectorgames->numgames;
                }
                if (cc == keyz[k_ngame])                                    // [Down]: Move to top of game list if smart menu is enabled
                {
@@ -503,49 +565,67 @@ int main(int argc, char *argv[])
                }
                if (cc == keyz[k_pclone])                                                     // [Left]: go to previous clone in list
                {
-                  if   (sel_clone == sel_game) sel_clone = gotolastclone(sel_game);
+                  if   (sel_clone == sel_game) sel_clone = sel_game->numclones ? sel_game->clones[sel_game->numclones-1] : sel_game;
                   else sel_clone = sel_clone->pclone;
                   if   (sel_clone == NULL)     sel_clone = sel_game;
                }
             }
          }
 
-         if (optz[o_borders]) drawborders(-X_MAX, -Y_MAX, X_MAX, Y_MAX, 0, 2, vwhite);       // Draw frame around the edge of the screen
+         // Only the layers of the screen that have changed are drawn again,
+         // the others are sent as the vectors they drew last time
+         redraw = cc || (vectorgames != drawnman) || (man_menu != drawnmenu) || (sel_clone != drawnclone) || (gamenum != drawnnum)
+                     || (vlod_level() != drawnlod);
+         drawnlod    = vlod_level();
+         drawnman    = vectorgames;
+         drawnmenu   = man_menu;
+         drawnclone  = sel_clone;
+         drawnnum    = gamenum;
 
-         // print the manufacturer name
-         strcpy(mytext, vectorgames->name);
-         if (man_menu)
-            setcolour(colours[c_col][c_sman], colours[c_int][c_sman]);
-         else
-            setcolour(colours[c_col][c_man], colours[c_int][c_man]);
-         //if (!optz[o_togpnm]) PrintString(mytext, 0, 300, 0, 12, 12, 0, c_align, optz[o_font]);            // manufacturer name, smaller if prev/next shown
-         //else PrintString(mytext, 0, 300, 0, 8+(4*(1-man_menu)), 8+(4*(1-man_menu)), 0, c_align, optz[o_font]);
-         PrintString(mytext, 0, 300, 0, 16, 16, 0, c_align, optz[o_font]);            // manufacturer name, smaller if prev/next shown
-         int pixel_length = StringPixelLength(mytext, 18, optz[o_font]);
-
-         setcolour(colours[c_col][c_arrow], colours[c_int][c_arrow]);
-         if (man_menu)                                                                       // Print Arrow pointing to games list, or...
-            PrintString("<", 0, 200, 90, 10, 10, 0, l_align, optz[o_font]);
-         else                                                                                // Print Arrow pointing to manufacturer list
-            PrintString(">", 0, 200, 90, 10, 10, 0, l_align, optz[o_font]);
-
-         if ((totgames>maxgamesonlist) && gamenum<(totgames- ((maxgamesonlist-1)/2) ))       // print a down arrow if there are games off the bottom
-            PrintString("<", 0, -350, 90, 10, 10, 0, l_align, optz[o_font]);
-
-         // print the next and previous manufacturers at the sides and arrows
-         if (man_menu)
+         // With detail dropped, the games list has fewer rows and/or the simple font
+         listrows = (drawnlod >= LOD_ROWS) ? maxgamesonlist - 4 : maxgamesonlist;
+         listfont = (drawnlod >= LOD_SIMPLE) ? 0 : optz[o_font];
+
+         if (layer_begin(lay_chrome, redraw))
          {
-            PrintString("< ", -pixel_length/2, 300, 0, 10, 10, 0, r_align, optz[o_font]);
-            PrintString(" >", pixel_length/2, 300, 0, 10, 10, 0, l_align, optz[o_font]);
+            if (optz[o_borders]) drawborders(-X_MAX, -Y_MAX, X_MAX, Y_MAX, 0, 2, vwhite);       // Draw frame around the edge of the screen
 
-            if (optz[o_togpnm])
+            // print the manufacturer name
+            strcpy(mytext, vectorgames->name);
+            if (man_menu)
+               setcolour(colours[c_col][c_sman], colours[c_int][c_sman]);
+            else
+               setcolour(colours[c_col][c_man], colours[c_int][c_man]);
+            //if (!optz[o_togpnm]) PrintString(mytext, 0, 300, 0, 12, 12, 0, c_align, optz[o_font]);            // manufacturer name, smaller if prev/next shown
+            //else PrintString(mytext, 0, 300, 0, 8+(4*(1-man_menu)), 8+(4*(1-man_menu)), 0, c_align, optz[o_font]);
+            PrintString(mytext, 0, 300, 0, 16, 16, 0, c_align, optz[o_font]);            // manufacturer name, smaller if prev/next shown
+            int pixel_length = StringPixelLength(mytext, 18, optz[o_font]);
+
+            setcolour(colours[c_col][c_arrow], colours[c_int][c_arrow]);
+            if (man_menu)                                                                       // Print Arrow pointing to games list, or...
+               PrintString("<", 0, 200, 90, 10, 10, 0, l_align, optz[o_font]);
+            else                                                                                // Print Arrow pointing to manufacturer list
+               PrintString(">", 0, 200, 90, 10, 10, 0, l_align, optz[o_font]);
+
+            if ((totgames>listrows) && gamenum<(totgames- ((listrows-1)/2) ))       // print a down arrow if there are games off the bottom
+               PrintString("<", 0, -350, 90, 10, 10, 0, l_align, optz[o_font]);
+
+            // print the next and previous manufacturers at the sides and arrows
+            if (man_menu)
             {
-               setcolour(colours[c_col][c_pnman], colours[c_int][c_pnman]);
-               strcpy(mytext, vectorgames->pmanuf->name);         // Print previous manufacturer name
-               PrintString(mytext, -xmax + 30, 300, 0, 5, 5, 0, l_align, optz[o_font]);
-               strcpy(mytext, vectorgames->nmanuf->name);         // print next manufacturer name
-               PrintString(mytext, xmax-30, 300, 0, 5, 5, 0, r_align, optz[o_font]);
+               PrintString("< ", -pixel_length/2, 300, 0, 10, 10, 0, r_align, optz[o_font]);
+               PrintString(" >", pixel_length/2, 300, 0, 10, 10, 0, l_align, optz[o_font]);
+
+               if (optz[o_togpnm])
+               {
+                  setcolour(colours[c_col][c_pnman], colours[c_int][c_pnman]);
+                  strcpy(mytext, vectorgames->pmanuf->name);         // Print previous manufacturer name
+                  PrintString(mytext, -xmax + 30, 300, 0, 5, 5, 0, l_align, optz[o_font]);
+                  strcpy(mytext, vectorgames->nmanuf->name);         // print next manufacturer name
+                  PrintString(mytext, xmax-30, 300, 0, 5, 5, 0, r_align, optz[o_font]);
+               }
             }
+            layer_end();
          }
 
          /*** Print manufacturer logos at side of screen ***/
@@ -553,140 +633,140 @@ int main(int argc, char *argv[])
          ucase(mytext);
          if (ticks > 240) width = cos(((ticks-240)*3)*M_PI/180); // 2 sec rotation (120 frames) so we mult by 3 for 360 degrees
          else width = 1;
-         if (!strcmp(mytext, "SEGA"))
-         {
-            sega.pos.x = -(xmax-80);
-            sega.angle = 90;
-            sega.scale.y = width;
-            drawshape(sega);
-            sega.pos.x = xmax-80;
-            sega.angle = 270;
-            drawshape(sega);
-         }
-         else if (!strcmp(mytext, "VECTREX"))
+         if (layer_begin(lay_logos, redraw || (width != drawnwidth)))
          {
-            vectrex.pos.x = -(xmax-80);
-            vectrex.angle = 90;
-            vectrex.scale.y = width*1.5;
-            drawshape(vectrex);
-            vectrex.pos.x = xmax-80;
-            vectrex.angle = 270;
-            drawshape(vectrex);
-         }
-         else if (!strcmp(mytext, "CENTURI"))
-         {
-            centuri.pos.x = -(xmax-80);
-            centuri.angle = 90;
-            centuri.scale.y = width;
-            drawshape(centuri);
-            centuri.pos.x = xmax-80;
-            centuri.angle = 270;
-            drawshape(centuri);
-         }
-         else if (!strcmp(mytext, "CINEMATRONICS"))
-         {
-            cinematronics.pos.x = -(xmax-130);
-            cinematronics.scale.x = width;
-            drawshape(cinematronics);
-            cinematronics.pos.x = xmax-130;
-            drawshape(cinematronics);
-         }
-         else if (!strcmp(mytext, "MIDWAY"))
-         {
-            midway.pos.x = -(xmax-130);
-            midway.scale.x = width;
-            drawshape(midway);
-            midway.pos.x = xmax-130;
-            drawshape(midway);
-         }
-         else if (!strcmp(mytext, "ATARI"))
-         {
-            atari.pos.x = -(xmax-130);
-            atari.scale.x = width*1.5;
-            drawshape(atari);
-            atari.pos.x = xmax-130;
-            drawshape(atari);
-         }
-         else if (!strcmp(mytext, "VECTORBEAM"))
-         {
-            vbeam.pos.x = -(xmax-80);
-            vbeam.angle = 90;
-            vbeam.scale.y = width;
-            drawshape(vbeam);
-            vbeam.angle = 270;
-            vbeam.pos.x = xmax-80;
-            drawshape(vbeam);
-         }
-         else
-         {
-            strcpy(mytext, vectorgames->name);         // print manufacturer name in text
-            setcolour(vcyan, EDGE_BRI-4);
-            PrintString(mytext, -(xmax-80), 0, 90, 14, width*14, 90, c_align, optz[o_font]);
-            PrintString(mytext, xmax-80, 0, 270, 14, width*14, 270, c_align, optz[o_font]);
-            //setcolour(vcyan, EDGE_BRI-8);
-            //PrintString(mytext, -(xmax-82), 2, 90, 14, width*14, 90, c_align);
-            //PrintString(mytext, xmax-82, 2, 270, 14, width*14, 270, c_align);
-            //setcolour(vcyan, EDGE_BRI-12);
-            //PrintString(mytext, -(xmax-84), 4, 90, 14, width*14, 90, c_align);
-            //PrintString(mytext, xmax-84, 4, 270, 14, width*14, 270, c_align);
+            if (!strcmp(mytext, "SEGA"))
+            {
+               sega.pos.x = -(xmax-80);
+               sega.angle = 90;
+               sega.scale.y = width;
+               drawshape(sega);
+               sega.pos.x = xmax-80;
+               sega.angle = 270;
+               drawshape(sega);
+            }
+            else if (!strcmp(mytext, "VECTREX"))
+            {
+               vectrex.pos.x = -(xmax-80);
+               vectrex.angle = 90;
+               vectrex.scale.y = width*1.5;
+               drawshape(vectrex);
+               vectrex.pos.x = xmax-80;
+               vectrex.angle = 270;
+               drawshape(vectrex);
+            }
+            else if (!strcmp(mytext, "CENTURI"))
+            {
+               centuri.pos.x = -(xmax-80);
+               centuri.angle = 90;
+               centuri.scale.y = width;
+               drawshape(centuri);
+               centuri.pos.x = xmax-80;
+               centuri.angle = 270;
+               drawshape(centuri);
+            }
+            else if (!strcmp(mytext, "CINEMATRONICS"))
+            {
+               cinematronics.pos.x = -(xmax-130);
+               cinematronics.scale.x = width;
+               drawshape(cinematronics);
+               cinematronics.pos.x = xmax-130;
+               drawshape(cinematronics);
+            }
+            else if (!strcmp(mytext, "MIDWAY"))
+            {
+               midway.pos.x = -(xmax-130);
+               midway.scale.x = width;
+               drawshape(midway);
+               midway.pos.x = xmax-130;
+               drawshape(midway);
+            }
+            else if (!strcmp(mytext, "ATARI"))
+            {
+               atari.pos.x = -(xmax-130);
+               atari.scale.x = width*1.5;
+               drawshape(atari);
+               atari.pos.x = xmax-130;
+               drawshape(atari);
+            }
+            else if (!strcmp(mytext, "VECTORBEAM"))
+            {
+               vbeam.pos.x = -(xmax-80);
+               vbeam.angle = 90;
+               vbeam.scale.y = width;
+               drawshape(vbeam);
+               vbeam.angle = 270;
+               vbeam.pos.x = xmax-80;
+               drawshape(vbeam);
+            }
+            else
+            {
+               strcpy(mytext, vectorgames->name);         // print manufacturer name in text
+               setcolour(vcyan, EDGE_BRI-4);
+               PrintString(mytext, -(xmax-80), 0, 90, 14, width*14, 90, c_align, optz[o_font]);
+               PrintString(mytext, xmax-80, 0, 270, 14, width*14, 270, c_align, optz[o_font]);
+               //setcolour(vcyan, EDGE_BRI-8);
+               //PrintString(mytext, -(xmax-82), 2, 90, 14, width*14, 90, c_align);
+               //PrintString(mytext, xmax-82, 2, 270, 14, width*14, 270, c_align);
+               //setcolour(vcyan, EDGE_BRI-12);
+               //PrintString(mytext, -(xmax-84), 4, 90, 14, width*14, 90, c_align);
+               //PrintString(mytext, xmax-84, 4, 270, 14, width*14, 270, c_align);
+            }
+            layer_end();
          }
+         drawnwidth = width;
 
-         // Now print the games list menu
-         top = 150;
-         int printed=0;
+         if (layer_begin(lay_list, redraw))
+         {
+            // Now print the games list menu
+            top = 150;
+            int printed=0;
          
-         gamelist_root = vectorgames->firstgame;                                 // point to game list for current manufacturer
+            gamenumtemp = 0;                                                  // index of the first game shown
 
-         if (totgames>maxgamesonlist)                                            // If we have a long list then we scroll it...
-         {
-            gamenumtemp=gamenum;
-            // maxgamesonlist+1)/2         is half way down the list - the scroll point
-            // ((maxgamesonlist-1)/2)-1    is the last n games where we don't need to scroll
-            while ((gamenumtemp>((maxgamesonlist+1)/2)) && (gamenumtemp<(totgames-(((maxgamesonlist-1)/2)-1))))                // If we are in the middle zone, scroll the list
+            if (totgames>listrows)                                            // If we have a long list then we scroll it...
             {
-               gamelist_root = gamelist_root->next;
-               gamenumtemp--;
+               // listrows+1)/2         is half way down the list - the scroll point
+               // ((listrows-1)/2)-1    is the last n games where we don't need to scroll
+               if (gamenum>=(totgames-(((listrows-1)/2)-1)))                  // If we are in the last 5 games of the list, stop scrolling
+                  gamenumtemp = totgames-listrows;
+               else if (gamenum>((listrows+1)/2))                             // If we are in the middle zone, scroll the list
+                  gamenumtemp = gamenum-((listrows+1)/2);
             }
-            if (gamenumtemp>=(totgames-(((maxgamesonlist-1)/2)-1)))              // If we are in the last 5 games of the list, stop scrolling
+
+            setcolour(colours[c_col][c_glist], colours[c_int][c_glist]);            // Set the colour outside of the loop to prevent repeated calls
+            do
             {
-               for (gamenumtemp=0;gamenumtemp<(totgames-maxgamesonlist);gamenumtemp++)
+               gamelist_root = vectorgames->games[gamenumtemp++];
+               strcpy(mytext, gamelist_root->name);                                 // mytext = name of parent game
+               gamesize = optz[o_fontsize];                                         // fontsize for gamelist
+               if (!man_menu && (sel_game == gamelist_root))                        // if we're at the selected game...
                {
-                  gamelist_root = gamelist_root->next;
+                  gamesize = optz[o_fontsize]+1;                                    // ...make font a bit bigger,
+                  if (sel_game != sel_clone) strcpy(mytext, sel_clone->name);       // ...change to clone name if different
+                  if (sel_game->nclone)
+                  {
+                     setcolour(colours[c_col][c_arrow], colours[c_int][c_arrow]);
+                     int pixel_length = StringPixelLength(mytext, gamesize, listfont);
+                     PrintString(" >", pixel_length/2, top, 0, gamesize, gamesize, 0, l_align, listfont);  // Arrow right showing there are clones
+                     PrintString("< ", -pixel_length/2, top, 0, gamesize, gamesize, 0, r_align, listfont); // Arrow left showing there are clones
+                  }
+                  setcolour(colours[c_col][c_sgame], colours[c_int][c_sgame]);
+                  PrintString(mytext, 0, top, 0, gamesize, gamesize, 0, c_align, listfont);   // This prevent needless "setcolour" calls per loop
+                  setcolour(colours[c_col][c_glist], colours[c_int][c_glist]);
                }
-            }
-         }
-
-         setcolour(colours[c_col][c_glist], colours[c_int][c_glist]);            // Set the colour outside of the loop to prevent repeated calls
-         do
-         {
-            strcpy(mytext, gamelist_root->name);                                 // mytext = name of parent game
-            gamesize = optz[o_fontsize];                                         // fontsize for gamelist
-            if (!man_menu && (sel_game == gamelist_root))                        // if we're at the selected game...
-            {
-               gamesize = optz[o_fontsize]+1;                                    // ...make font a bit bigger,
-               if (sel_game != sel_clone) strcpy(mytext, sel_clone->name);       // ...change to clone name if different
-               if (sel_game->nclone)
+               else
                {
-                  setcolour(colours[c_col][c_arrow], colours[c_int][c_arrow]);
-                  int pixel_length = StringPixelLength(mytext, gamesize, optz[o_font]);
-                  PrintString(" >", pixel_length/2, top, 0, gamesize, gamesize, 0, l_align, optz[o_font]);  // Arrow right showing there are clones
-                  PrintString("< ", -pixel_length/2, top, 0, gamesize, gamesize, 0, r_align, optz[o_font]); // Arrow left showing there are clones
+                  if (strstr(mytext, " (") != NULL)
+                     mytext[strstr(mytext, " (") - mytext] = 0;                     // ... and strip off version info
+                  PrintString(mytext, 0, top, 0, gamesize, gamesize, 0, c_align, listfont);
                }
-               setcolour(colours[c_col][c_sgame], colours[c_int][c_sgame]);
-               PrintString(mytext, 0, top, 0, gamesize, gamesize, 0, c_align, optz[o_font]);   // This prevent needless "setcolour" calls per loop
-               setcolour(colours[c_col][c_glist], colours[c_int][c_glist]);
+               top -= 35;
+               printed++;
             }
-            else
-            {
-               if (strstr(mytext, " (") != NULL)
-                  mytext[strstr(mytext, " (") - mytext] = 0;                     // ... and strip off version info
-               PrintString(mytext, 0, top, 0, gamesize, gamesize, 0, c_align, optz[o_font]);
-            }
-            gamelist_root = gamelist_root->next;
-            top -= 35;
-            printed++;
+            while ((gamenumtemp < totgames) && (printed<listrows));
+            layer_end();
          }
-         while ((gamelist_root != vectorgames->firstgame) && (printed<maxgamesonlist));
       }
       timeout ++;                                       // screensaver timer
       ticks=(ticks+1)%360;                              // counter
@@ -707,7 +787,7 @@ int main(int argc, char *argv[])
    }
    iniparser_freedict(ini);
    printf("Quitting to OS...\n");
-   cc=credits();
+   if (!benchframes) cc=credits();
    //check value of cc (key pressed) to determine whether to shutdown
    printf("\n%s, (c) 2009-2020\n", auth1);
    printf("%s\n", auth2);
@@ -725,24 +805,10 @@ int main(int argc, char *argv[])
 ********************************************************************/
 int StringPixelLength(char *text, float xScale, int font)
 {
-   int num_chars, pixel_length, c;
-   const hershey_char_t * f;
+   int pixel_length;
 
    if (optz[o_ucase]) ucase(text);
-   pixel_length = 0;
-   num_chars = strlen(text);
-   for (c=0; c < num_chars; c++)
-   {
-      if (font == 1)
-      {
-        f = &hershey_simplex[(text[c]) - ' '];
-      }
-      else
-      {
-        f = &vector_simplex[(text[c]) - ' '];
-      }
-      pixel_length = pixel_length + (f->width);
-   }
+   pixel_length = vfont_layout(text, vfont_get(font), NULL);
    pixel_length = pixel_length * (xScale * 0.15);
    return pixel_length;
 }
@@ -759,101 +825,198 @@ int StringPixelLength(char *text, float xScale, int font)
 ********************************************************************/
 void PrintString(char *text, int xpos, int ypos, int charangle, float xScale, float yScale, int lineangle, int alignment, int font)
 {
-   int c, i, num_chars, pixel_length;
-   int x1, y1, x2, y2;
-   point line_start, line_end, cvs, cve;
-   float textx, texty, halfstring;
-   const hershey_char_t * f;
-   char  mytext[100];
-   
-   strcpy(mytext, text);
-   if (optz[o_ucase]) ucase(mytext);
+   int c, g, i, n, num_chars, pixel_length, level, vectors, saved;
+   int xoff[VTEXT_LEN];
+   point pos;
+   float halfstring, offset;
+   vmatrix screen, line, start, glyph, at;
+   const v_font * vf;
+   const v_vertex * s;
+   const point * l;
+   point * out;
+   v_textkey key;
    
-   pixel_length = StringPixelLength(mytext, xScale, font);
-   num_chars = strlen(mytext);
-
-   xScale = (xScale * 0.15);
-   yScale = (yScale * 0.15);
-  
-   // calculate halfway point of string to centre it around given x position
-   halfstring = pixel_length / 2;
-
-   // Calculate the start and endpoints of the line we are writing on
-   // and then rotate the line about the centre point.
-   // We can use the length to calculate the start X position and L, R or centre align the text
-   switch (alignment)
-   {
-      case l_align:   // Left aligned
-         line_start = fnrotate(lineangle, xpos, ypos, xpos, ypos);
-         line_end   = fnrotate(lineangle, xpos + 2*halfstring, ypos, xpos, ypos);
-         break;
-      case r_align:   // Right aligned
-         line_start = fnrotate(lineangle, xpos - 2*halfstring, ypos, xpos, ypos);
-         line_end   = fnrotate(lineangle, xpos, ypos, xpos, ypos);
-         break;
-      default:        //Centred
-         line_start = fnrotate(lineangle, xpos - halfstring, ypos, xpos, ypos);
-         line_end   = fnrotate(lineangle, xpos + halfstring, ypos, xpos, ypos);
-   }
-
-   #if DEBUG
-   drawvector(line_start, line_end, 0, 0);         // For testing, draw the line the text will be printed along
-   #endif
-
-   // Set the character print position to the beginning of the line.
-   textx = line_start.x;
-   texty = line_start.y; 
-
-   // Loop through the string and print each character
-   for (c=0; c<num_chars; c++)
+   strcpy(key.text, text);
+   if (optz[o_ucase]) ucase(key.text);
+   key.font      = font;
+   key.xScale    = xScale;
+   key.yScale    = yScale;
+   key.charangle = charangle;
+   key.lineangle = lineangle;
+   key.alignment = alignment;
+   key.rot       = optz[o_rot];
+
+   // The string's polylines are kept relative to x,y, so they just need
+   // moving to where it's printed
+   screen = screenmatrix();
+   pos = mxapply(&screen, xpos, ypos);
+   at = mxmake(0, 1, 1, pos.x, pos.y);
+
+   // If the string has been printed recently, its polylines are ready to go,
+   // otherwise lay it out and keep them for next time
+   l = vtext_find(&key, &n, &vectors, &saved);
+   if (l == NULL)
    {
-      if (font == 1)
+      // Find where each character starts along the line, and the string length
+      vf = vfont_get(font);
+      pixel_length = vfont_layout(key.text, vf, xoff) * (xScale * 0.15);
+      num_chars = strlen(key.text);
+
+      xScale = (xScale * 0.15);
+      yScale = (yScale * 0.15);
+
+      // Small text is drawn with simpler curves, as much as can't be seen
+      level = vsimp_level((fabs(xScale) > fabs(yScale)) ? xScale : yScale);
+     
+      // calculate halfway point of string to centre it around given x position
+      halfstring = pixel_length / 2;
+
+      // Calculate the start and endpoints of the line we are writing on
+      // and then rotate the line about the centre point.
+      // We can use the length to calculate the start X position and L, R or centre align the text
+      switch (alignment)
       {
-        f = &hershey_simplex[(mytext[c]) - ' '];
+         case l_align:   // Left aligned
+            offset = 0;
+            break;
+         case r_align:   // Right aligned
+            offset = -2*halfstring;
+            break;
+         default:        //Centred
+            offset = -halfstring;
       }
-      else
+      line = mxmake(lineangle, 1, 1, 0, 0);
+
+      #if DEBUG
+      // For testing, draw the line the text will be printed along (when it's laid out)
+      drawvector(mxapply(&line, offset, 0), mxapply(&line, offset + 2*halfstring, 0), xpos, ypos);
+      #endif
+
+      // Each character's polylines, with a pen up between characters
+      n = vectors = saved = 0;
+      for (c=0; c<num_chars; c++)
       {
-        f = &vector_simplex[(mytext[c]) - ' '];
+         g = VFONT_GLYPH(key.text[c]);
+         if (vf->count[level][g]) n += vf->count[level][g] + 1;
+         vectors += vf->vectors[level][g];
+         saved += vf->vectors[0][g] - vf->vectors[level][g];
       }
-      if (f->count > 0)
+      l = out = vtext_add(&key, n, vectors, saved);
+      if (out == NULL) return;      // out of memory
+
+      // Every character is rotated and scaled the same way, so only the
+      // position needs changing from one character to the next
+      start = mxmul(screen, line);
+      glyph = mxmul(screen, mxmake(charangle, xScale, yScale, 0, 0));
+
+      // Loop through the string and lay out each character
+      for (c=0; c<num_chars; c++)
       {
-         x1 = f->points[0];
-         y1 = f->points[1] - 11;                    // We take away 11 as this is half of the height of the character, to centre the rotation
-         for (i=1; i<f->count; i++)                 // number of points
-         {
-            x2 = f->points[i*2 + 0];                // Read next x co-ordinate
-            y2 = f->points[i*2 + 1] - 11;           // Read next y co-ordinate
-            if ((x1 != -1) && (x2 != -1))           // If not moving position, we draw a vector
-            {
-               cvs = fnrotate(charangle, x1 * xScale, y1 * yScale, 0, 0);
-               cve = fnrotate(charangle, x2 * xScale, y2 * yScale, 0, 0);
-               drawvector(cvs, cve, textx, texty);
-            }
-            x1 = x2;
-            y1 = y2;
+         g = VFONT_GLYPH(key.text[c]);
+         pos = mxapply(&start, offset + (xoff[c] * xScale), 0);
+         glyph.tx = pos.x;
+         glyph.ty = pos.y;
+         if (vf->count[level][g] == 0) continue;
+         s = &vf->points[vf->first[level][g]];
+         for (i=0; i<vf->count[level][g]; i++, s++, out++)
+         {
+            if (s->x == VFONT_PENUP)
+               out->x = PEN_UP;
+            else
+               *out = mxapply(&glyph, s->x, s->y);
          }
+         out->x = PEN_UP;
+         out++;
       }
-      textx = textx + (cos(lineangle*(M_PI/180)) * (f->width*xScale));
-      texty = texty + (sin(lineangle*(M_PI/180)) * (f->width*xScale));
    }
+
+   vsimp_count((key.xScale < 1) ? 1 : key.xScale + 0.5, vectors, saved);
+   drawpolyline(&at, l, n);
+}
+
+
+/*******************************************************************
+ Make a transform that scales by xScale, yScale, rotates by angle
+ degrees around the origin, then moves the origin to x,y.
+ Right angles are exact, so square-on shapes stay square-on.
+********************************************************************/
+vmatrix mxmake(int angle, float xScale, float yScale, float x, float y)
+{
+   vmatrix m;
+   float   cs, sn;
+   angle = angle % 360;
+   if (angle < 0) angle += 360;
+   switch (angle)
+   {
+      case 0:   cs =  1; sn =  0; break;
+      case 90:  cs =  0; sn =  1; break;
+      case 180: cs = -1; sn =  0; break;
+      case 270: cs =  0; sn = -1; break;
+      default:
+         cs = cos(angle * (M_PI/180));
+         sn = sin(angle * (M_PI/180));
+   }
+   m.a  = cs * xScale;
+   m.b  = -sn * yScale;
+   m.c  = sn * xScale;
+   m.d  = cs * yScale;
+   m.tx = x;
+   m.ty = y;
+   return m;
 }
 
 
 /*******************************************************************
- Rotate co-ordinates x,y around the origin. Returns a point.
- trans x,y provides offset to translate rotation point to origin
+ Combine two transforms into one which applies r, then l
 ********************************************************************/
-point fnrotate(int angle, float x, float y, float x_trans, float y_trans)
+vmatrix mxmul(vmatrix l, vmatrix r)
+{
+   vmatrix m;
+   m.a  = l.a * r.a + l.b * r.c;
+   m.b  = l.a * r.b + l.b * r.d;
+   m.c  = l.c * r.a + l.d * r.c;
+   m.d  = l.c * r.b + l.d * r.d;
+   m.tx = l.a * r.tx + l.b * r.ty + l.tx;
+   m.ty = l.c * r.tx + l.d * r.ty + l.ty;
+   return m;
+}
+
+
+/*******************************************************************
+ Transform co-ordinates x,y. Returns a point.
+********************************************************************/
+point mxapply(vmatrix *m, float x, float y)
 {
    point p;
-   x = (x - x_trans);
-   y = (y - y_trans);
-   p.x = (x * cos(angle * (M_PI/180)) - y * sin(angle * (M_PI/180))) + x_trans;
-   p.y = (x * sin(angle * (M_PI/180)) + y * cos(angle * (M_PI/180))) + y_trans;
+   p.x = m->a * x + m->b * y + m->tx;
+   p.y = m->c * x + m->d * y + m->ty;
    return p;
 }
 
 
+/*******************************************************************
+ Transform for the screen rotation, the same as drawvector() does
+ for each vector. Uses the global rotation setting.
+********************************************************************/
+vmatrix screenmatrix(void)
+{
+   vmatrix m = {1, 0, 0, 1, 0, 0};
+   switch (optz[o_rot])
+   {
+      case 1:     // rotated LEFT (90 deg CW)
+         m.a = 0; m.b =  1; m.c = -1; m.d =  0;
+         break;
+      case 2:     // Rotated 180 deg
+         m.a = -1; m.b = 0; m.c = 0; m.d = -1;
+         break;
+      case 3:     // rotated RIGHT (90 deg CCW)
+         m.a = 0; m.b = -1; m.c =  1; m.d =  0;
+         break;
+   }
+   return m;
+}
+
+
 /*******************************************************************
  Draw a shape at position x, y on screen, rotated by 'angle' degrees
  and scaled by factors xScale, yScale
@@ -861,34 +1024,116 @@ point fnrotate(int angle, float x, float y, float x_trans, float y_trans)
 ********************************************************************/
 void drawshape(vObject shape)
 {
-   int ii;
-   float x1, x2, y1, y2;
-   point start_p, end_p;
+   int ii, jj, rr, points, vectors;
+   point   p, *strip;
+   vmatrix m;
+   // Drop what detail is too small to see at the shape's scale
+   strip = shapestrip(shape.outline, vsimp_level((fabs(shape.scale.x) > fabs(shape.scale.y)) ? shape.scale.x : shape.scale.y), &points, &vectors);
+   vsimp_count(0, vectors, shape.outline.size/4 - vectors);
    setcolour(shape.colour, shape.bright);
-   for (ii=0; ii<shape.outline.size; ii+=4)
+   // One transform for the whole shape, rotating and scaling it about
+   // its centre point, then moving it to its position on the screen
+   m = mxmul(screenmatrix(), mxmake(shape.angle, shape.scale.x, shape.scale.y, shape.pos.x, shape.pos.y));
+   p = mxapply(&m, -shape.cent.x, -shape.cent.y);
+   m.tx = p.x;
+   m.ty = p.y;
+   if (strip == NULL)
+   {
+      // Couldn't be made into polylines, draw it a vector at a time
+      for (ii=0, rr=0; ii<shape.outline.size; ii+=4)
+      {
+         while ((rr < shape.outline.nruns) && (shape.outline.runs[rr].start == ii/4)) runcolour(&shape, rr++);
+         drawxform(&m, shape.outline.array[ii + 0], shape.outline.array[ii + 1], shape.outline.array[ii + 2], shape.outline.array[ii + 3]);
+      }
+      return;
+   }
+   // Draw up to each pen up that starts a colour run, then change colour
+   for (ii=0; ii<points; ii=jj)
    {
-      x1 = shape.outline.array[ii + 0] - shape.cent.x;
-      y1 = shape.outline.array[ii + 1] - shape.cent.y;
-      x2 = shape.outline.array[ii + 2] - shape.cent.x;
-      y2 = shape.outline.array[ii + 3] - shape.cent.y;
-      // This next line is a horrible hack to change colour to red when the
-      // co-ords of "vector" in the Mame logo are found
-      // I did say colour was an afterthought... one day I'll implement
-      // a tandem colour array for each vector in a vObject
-      if ((shape.outline.array[ii + 0] == 154) && (shape.outline.array[ii + 1] == 20) && (shape.outline.array[ii + 2] == 154) && (shape.outline.array[ii + 3] == 0))
-         setcolour(vred, shape.bright);
-      // Dark Blue inner "SEGA"
-      if ((shape.outline.array[ii + 0] == 0) && (shape.outline.array[ii + 1] == 12) && (shape.outline.array[ii + 2] == 40) && (shape.outline.array[ii + 3] == 12))
-         setcolour(vblue, shape.bright);
-
-      start_p   = fnrotate(shape.angle, x1 * shape.scale.x, y1 * shape.scale.y, 0, 0);
-      end_p      = fnrotate(shape.angle, x2 * shape.scale.x, y2 * shape.scale.y, 0, 0);
-      //printf("x: %f, y:%f\n", start_p.x, start_p.y);
-      drawvector(start_p, end_p, shape.pos.x, shape.pos.y);
+      if (strip[ii].y >= 0) runcolour(&shape, strip[ii].y);
+      for (jj=ii+1; (jj<points) && !((strip[jj].x == PEN_UP) && (strip[jj].y >= 0)); jj++);
+      drawpolyline(&m, &strip[ii], jj - ii);
    }
 }
 
 
+/*******************************************************************
+ Set the colour and brightness of run r of a shape's outline
+********************************************************************/
+void runcolour(vObject *shape, int r)
+{
+   const vRun *run = &shape->outline.runs[r];
+   setcolour((run->colour < 0) ? shape->colour : run->colour, (run->bright < 0) ? shape->bright : run->bright);
+}
+
+
+/*******************************************************************
+ Return a shape's outline as polylines simplified to level, setting
+ points to the number of points and vectors to the number of
+ vectors drawn through them. Each shape is turned into polylines
+ at every level the first time it is drawn, a colour run at a time
+ so the colours still change in the same places. Every run starts
+ with a pen up, its y the run's index, or -1 for the vectors before
+ the first run. Returns NULL if the shape doesn't fit in the table,
+ or there isn't the memory.
+********************************************************************/
+point* shapestrip(vShape shape, int level, int *points, int *vectors)
+{
+   int   i, k, l, r, from, to, v, count, n = shape.size / 4, *segs, *xy;
+   point *p;
+   *points  = 0;
+   *vectors = n;
+   for (i = 0; (i < SHAPE_STRIPS) && shapestrips[i].array; i++)
+   {
+      if (shapestrips[i].array == shape.array) break;
+   }
+   if (i == SHAPE_STRIPS) return NULL;
+   if (shapestrips[i].array == NULL)
+   {
+      segs = malloc(n * 4 * sizeof(int) + 1);
+      xy   = malloc(n * 6 * sizeof(int) + 1);
+      for (l = 0; (l < VSIMP_LEVELS) && segs && xy; l++)
+      {
+         p = shapestrips[i].strip[l] = malloc((n * 3 + shape.nruns + 1) * sizeof(point));
+         if (p == NULL) break;
+         shapestrips[i].vectors[l] = 0;
+         for (r = -1; r < shape.nruns; r++)
+         {
+            from = (r < 0) ? 0 : shape.runs[r].start;
+            to   = (r + 1 < shape.nruns) ? shape.runs[r + 1].start : n;
+            // Even an empty run gets its pen up, so its colour is still set
+            p->x = PEN_UP;
+            p->y = r;
+            p++;
+            if (from >= to) continue;
+            v = vsimp_segments(&shape.array[from * 4], to - from, segs, vsimp_tol[l]);
+            shapestrips[i].vectors[l] += v;
+            count = vsimp_strips(segs, v, xy, PEN_UP);
+            for (k = 0; k < count; k++, p++)
+            {
+               p->x = xy[k*2];
+               p->y = xy[k*2 + 1];
+            }
+         }
+         shapestrips[i].points[l] = p - shapestrips[i].strip[l];
+      }
+      free(segs);
+      free(xy);
+      if (l < VSIMP_LEVELS)
+      {
+         // out of memory, try again next time
+         while (l >= 0) free(shapestrips[i].strip[l--]);
+         memset(&shapestrips[i], 0, sizeof(shapestrips[i]));
+         return NULL;
+      }
+      shapestrips[i].array = shape.array;
+   }
+   *points  = shapestrips[i].points[level];
+   *vectors = shapestrips[i].vectors[level];
+   return shapestrips[i].strip[level];
+}
+
+
 /*******************************************************************
             Draw borders between x and y values
 ********************************************************************/
@@ -1044,8 +1289,14 @@ vObject intro(void)
    253,0,273,20,     273,20,288,20,    288,20,278,10,    278,10,273,10,    273,10,273,0      // R
    };
 
+   static const vRun mameruns[] = {
+   {37, vred, -1}                                                                            // "VECTOR" in red
+   };
+
    mame.outline.array = mamelogo;
    mame.outline.size = sizeof(mamelogo) / sizeof(*mamelogo);
+   mame.outline.runs = mameruns;
+   mame.outline.nruns = sizeof(mameruns)/sizeof(*mameruns);
    mame.pos.x = 0;         // centre screen
    mame.pos.y = 0;         // centre screen
    mame.inc.x = 0;         // don't move
@@ -1169,6 +1420,8 @@ vObject make_asteroid(void)
       asteroid.outline.size = sizeof(ast4)/sizeof(*ast4);
       break;
    }
+   asteroid.outline.runs = NULL;
+   asteroid.outline.nruns = 0;
    asteroid.pos.x = NewXPos();
    asteroid.pos.y = NewYPos();
    asteroid.inc.x = ((NewXYInc() * NewDir() ) / 5) + 0.25;
@@ -1216,7 +1469,7 @@ int reallyescape(void)
    {
       for (count=0; count < NUM_ASTEROIDS; count++)
       {
-         drawshape(asteroid[count]);
+         if (count < shownasteroids()) drawshape(asteroid[count]);
          asteroid[count] = updateobject(asteroid[count]);
       }
       if (optz[o_stars]) showstars();
@@ -1271,9 +1524,15 @@ vObject make_sega(void)
    //a
    223,0,251,59,  251,59,257,59, 257,59,278,14, 278,14,251,14 };
 
+   static const vRun segaruns[] = {
+   {55, vblue, -1}               // Dark Blue inner "sega"
+   };
+
    vObject   sega;// 0 - 297, 0 - 74
    sega.outline.array = segalogo;
    sega.outline.size = sizeof(segalogo)/sizeof(*segalogo);
+   sega.outline.runs = segaruns;
+   sega.outline.nruns = sizeof(segaruns)/sizeof(*segaruns);
    sega.pos.x = -350;
    sega.pos.y = 0;
    sega.inc.x = 0;
@@ -1310,6 +1569,8 @@ vObject make_cinematronics(void)
    vObject   cinematronics;
    cinematronics.outline.array = cinematronicslogo;
    cinematronics.outline.size = sizeof(cinematronicslogo)/sizeof(*cinematronicslogo);
+   cinematronics.outline.runs = NULL;
+   cinematronics.outline.nruns = 0;
    cinematronics.pos.x = -350;
    cinematronics.pos.y = 0;
    cinematronics.inc.x = 0;
@@ -1355,6 +1616,8 @@ vObject make_centuri(void)
    vObject   centuri;
    centuri.outline.array = centurilogo;
    centuri.outline.size = sizeof(centurilogo)/sizeof(*centurilogo);
+   centuri.outline.runs = NULL;
+   centuri.outline.nruns = 0;
    centuri.pos.x = -350;
    centuri.pos.y = 0;
    centuri.inc.x = 0;
@@ -1394,6 +1657,8 @@ vObject make_atari(void)
    vObject   atari;
    atari.outline.array = atarilogo;
    atari.outline.size = sizeof(atarilogo)/sizeof(*atarilogo);
+   atari.outline.runs = NULL;
+   atari.outline.nruns = 0;
    atari.pos.x = -350;
    atari.pos.y = 0;
    atari.inc.x = 0;
@@ -1430,6 +1695,8 @@ vObject make_vbeam(void)
    vObject   vbeam;
    vbeam.outline.array = vbeamlogo;
    vbeam.outline.size = sizeof(vbeamlogo)/sizeof(*vbeamlogo);
+   vbeam.outline.runs = NULL;
+   vbeam.outline.nruns = 0;
    vbeam.pos.x = -350;
    vbeam.pos.y = 0;
    vbeam.inc.x = 0;
@@ -1472,6 +1739,8 @@ vObject make_midway(void)
    vObject   midway;
    midway.outline.array = midwaylogo;
    midway.outline.size = sizeof(midwaylogo)/sizeof(*midwaylogo);
+   midway.outline.runs = NULL;
+   midway.outline.nruns = 0;
    midway.pos.x = -350;
    midway.pos.y = 0;
    midway.inc.x = 0;
@@ -1519,6 +1788,8 @@ vObject make_vectrex(void)
    vObject   vectrex;
    vectrex.outline.array = vectrexlogo;
    vectrex.outline.size = sizeof(vectrexlogo)/sizeof(*vectrexlogo);
+   vectrex.outline.runs = NULL;
+   vectrex.outline.nruns = 0;
    vectrex.pos.x = -350;
    vectrex.pos.y = 0;
    vectrex.inc.x = 0;
@@ -1596,12 +1867,7 @@ int credits(void)
    #ifdef USBDVG
    if (ZVGPresent == 2)
    {
-      char value[16];
-      if (zvgGetOption("bwDisplay", value, sizeof(value)) == 0)
-      {
-         //printf("Is Mono: %s\n", value);
-         mono = (strcmp(value, "true") == 0);
-      }
+      mono = zvgGetCaps()->bwDisplay;
    }
    #else
    if (ZVGPresent == 1)
@@ -1815,11 +2081,20 @@ void showstars()
    for (c=0; c < (NUM_STARS); c++)
    {
       starz[c] = updatestar(starz[c]);
-      drawstar(starz[c]);
+      if (vlod_level() < LOD_NOSTARS) drawstar(starz[c]);    // keep them moving even when not drawn
    }
 }
 
 
+/*******************************************************************
+ Number of asteroids to draw, fewer if detail has been dropped
+********************************************************************/
+int shownasteroids(void)
+{
+   return (vlod_level() >= LOD_FEWROCKS) ? NUM_ASTEROIDS/2 : NUM_ASTEROIDS;
+}
+
+
 /******************************************************************
 Read the cfg file settings
 Section:option_name, default_value
@@ -1864,6 +2139,10 @@ void getsettings(void)
    optz[o_mpoint]    = iniparser_getboolean(ini, "controls:pointer", 0);
    if (optz[o_msens] < 1) optz[o_msens] = 1;
    jsdeadzone        = iniparser_getint(ini, "controls:jsdeadzone", 32000);    //Get joystick deadzone value if present, otherwise default it to 32000
+   beamopt           = iniparser_getint(ini, "interface:beamopt", 0);           // Reorder vectors to cut beam travel, off unless set
+   autodetail        = iniparser_getint(ini, "interface:autodetail", 1);        // Drop detail to keep up with the VG, on unless set
+   colourgroup       = iniparser_getint(ini, "interface:colourgroup", 0);       // Reorder vectors to cut colour changes, off unless set
+   framerate         = iniparser_getint(ini, "interface:framerate", 0);         // Frame rate, hardware default unless set
 
    // key bindings - global keys
    keyz[k_menu]      = iniparser_getint(ini, "keys:k_togglemenu", HYPSPACE);
@@ -1984,6 +2263,10 @@ void writecfg()
    writeinival("interface:fontsize",            optz[o_fontsize], 1, 0);
    writeinival("interface:borders",             optz[o_borders], 1, 3);
    writeinival("interface:volume",              optz[o_volume], 1, 0);
+   writeinival("interface:beamopt",             beamopt, 0, 0);
+   writeinival("interface:autodetail",          autodetail, 0, 0);
+   writeinival("interface:colourgroup",         colourgroup, 0, 0);
+   writeinival("interface:framerate",           framerate, 0, 0);
 
    iniparser_set(ini, "interface:attractargs",  attractargs);
 
@@ -2055,38 +2338,12 @@ int getcolour(const char *colval)
 ********************************************************************/
 g_node* GetRandomGame(m_node *gameslist)
 {
-   int          x=0, rf;
-   m_node       *randommanuf;
-   g_node       *randomgame, *randomclone;
-   randommanuf = gameslist;
-   randomgame  = randommanuf->firstgame;
-   randomclone = randomgame;
+   int          rf;
    rf          = (rand()/(RAND_MAX/totalnumgames+1));
    //printf("Random factor = %d\n", rf);
 
-   while (x < rf)
-   {
-      if (randomclone->nclone != NULL)                   // if not at last clone, next clone
-      {
-         randomclone = randomclone->nclone;
-      }
-      else
-      {
-         if (randomgame->next != randommanuf->firstgame) // if at bottom of list, next manuf
-         {
-            randomgame = randomgame->next;
-            randomclone = randomgame;
-         }
-         else
-         {
-            randommanuf = randommanuf->nmanuf;
-            randomgame = randommanuf->firstgame;
-            randomclone = randomgame;
-         }
-      }
-      x++;
-   }
-   return randomclone;
+   // count on rf games and clones from the start of gameslist, going round to the first manufacturer
+   return nthgame((gameslist->first + rf) % totalnumgames);
 }
 
 
@@ -2177,40 +2434,40 @@ void SetOptions(void)
       options = 12;
 
       setcolour(vwhite, 25);
-      PrintString(">", -320, (top-((cursor+1)*spacing)), 0, optz[o_fontsize]-2, optz[o_fontsize], 0, r_align, 0);
+      PrintString(">", -320, (top-((cursor+1)*spacing)), 0, optz[o_fontsize]-2, optz[o_fontsize], 0, r_align, optz[o_font]);
 
       // Control Panel Type
       top-=spacing;
       setcolour(vwhite, 15);
       if (cursor == 0)   setcolour(vwhite, 25);
-      PrintString("Control Panel", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      if (optz[o_cpanel] == 0) PrintString("Buttons", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      if (optz[o_cpanel] == 1) PrintString("Joystick", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      if (optz[o_cpanel] == 2) PrintString("Spinner", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Control Panel", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      if (optz[o_cpanel] == 0) PrintString("Buttons", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      if (optz[o_cpanel] == 1) PrintString("Joystick", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      if (optz[o_cpanel] == 2) PrintString("Spinner", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == 0)   setcolour(vwhite, 15);
 
       // Screen rotation
       top-=spacing;
       if (cursor == 1)   setcolour(vwhite, 25);
-      PrintString("Rotation", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Rotation", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (optz[o_rot] == 0) strcpy(buffer,"0");
       if (optz[o_rot] == 1) strcpy(buffer,"90");
       if (optz[o_rot] == 2) strcpy(buffer,"180");
       if (optz[o_rot] == 3) strcpy(buffer,"270");
-      PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == 1)   setcolour(vwhite, 15);
 
       // Stars
       top-=spacing;
       if (cursor == 2)   setcolour(vwhite, 25);      // Set the colour to bright if we're at this option
-      PrintString("Stars", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString(optz[o_stars] == 1 ? "yes" : "no", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Stars", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString(optz[o_stars] == 1 ? "yes" : "no", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == 2)   setcolour(vwhite, 15);      // Doing this prevents having to reset the colour for every option
 
       // Font Selection
       top-=spacing;
       if (cursor == 3)   setcolour(vwhite, 25);
-      PrintString("Font", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Font", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (optz[o_font] == 0)
       {
          PrintString("Classic", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
@@ -2224,16 +2481,16 @@ void SetOptions(void)
       // Caps
       top-=spacing;
       if (cursor == 4)   setcolour(vwhite, 25);
-      PrintString("All Caps", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString((optz[o_ucase] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("All Caps", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString((optz[o_ucase] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == 4)   setcolour(vwhite, 15);
 
       // Font Size
       top-=spacing;
       if (cursor == 5)   setcolour(vwhite, 25);
-      PrintString("Font Size", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Font Size", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       sprintf(buffer, "%u", optz[o_fontsize]-4);
-      PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == 5)   setcolour(vwhite, 15);
 
       // Mouse/Spinner options
@@ -2242,12 +2499,12 @@ void SetOptions(void)
          options+=1;                  // Mouse found so we have an extra option to consider
          top-=spacing;
          if (cursor == 6)   setcolour(vwhite, 25);
-         PrintString("Optical Control", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+         PrintString("Optical Control", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
          if (optz[o_mouse] == 0) strcpy(buffer,"None");
          if (optz[o_mouse] == 1) strcpy(buffer,"X-Spinner");
          if (optz[o_mouse] == 2) strcpy(buffer,"Y-Spinner");
          if (optz[o_mouse] == 3) strcpy(buffer,"Trackball");
-         PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+         PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
          if (cursor == 6)   setcolour(vwhite, 15);
 
          if (optz[o_mouse])
@@ -2262,23 +2519,23 @@ void SetOptions(void)
 
             // Reverse X Axis
             if (cursor == 7)   setcolour(vwhite, 25);
-            PrintString("- Reverse X Axis", col1+2*optz[o_fontsize]-8, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-            PrintString((optz[o_mrevX] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+            PrintString("- Reverse X Axis", col1+2*optz[o_fontsize]-8, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+            PrintString((optz[o_mrevX] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
             if (cursor == 7)   setcolour(vwhite, 15);
 
             // Reverse Y Axis
             top-=spacing;
             if (cursor == 8)   setcolour(vwhite, 25);
-            PrintString("- Reverse Y Axis", col1+2*optz[o_fontsize]-8, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-            PrintString((optz[o_mrevY] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+            PrintString("- Reverse Y Axis", col1+2*optz[o_fontsize]-8, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+            PrintString((optz[o_mrevY] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
             if (cursor == 8)   setcolour(vwhite, 15);
 
             // Mouse Sensitivity
             top-=spacing;
             if (cursor == 9)   setcolour(vwhite, 25);
-            PrintString("- Sensitivity", col1+2*optz[o_fontsize]-8, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+            PrintString("- Sensitivity", col1+2*optz[o_fontsize]-8, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
             sprintf(buffer, "%i", optz[o_msens]);
-            PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+            PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
             if (cursor == 9)   setcolour(vwhite, 15);
          }
       }
@@ -2286,60 +2543,60 @@ void SetOptions(void)
       // Edit Games List
       top-=spacing;
       if (cursor == options - 6)   setcolour(vwhite, 25);
-      PrintString("Show/Hide Games", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString( ">", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Show/Hide Games", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString( ">", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == options - 6)   setcolour(vwhite, 15);
 
       // Edit Menu Colours
       top-=spacing;
       if (cursor == options - 5)   setcolour(vwhite, 25);
-      PrintString("Edit Menu Colours", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString( ">", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Edit Menu Colours", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString( ">", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == options - 5)   setcolour(vwhite, 15);
 
       // Monitor Test Patterns
       top-=spacing;
       if (cursor == options - 4)   setcolour(vwhite, 25);
-      PrintString("Test Patterns", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString( ">", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Test Patterns", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString( ">", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == options - 4)   setcolour(vwhite, 15);
 
       // Show Prev and Next
       top-=spacing;
       if (cursor == options - 3)   setcolour(vwhite, 25);
-      PrintString("Show Prev/Next", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString((optz[o_togpnm] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Show Prev/Next", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString((optz[o_togpnm] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == options - 3)   setcolour(vwhite, 15);
 
       // Borders
       top-=spacing;
       if (cursor == options - 2)   setcolour(vwhite, 25);
-      PrintString("Borders", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
-      PrintString((optz[o_borders] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Borders", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
+      PrintString((optz[o_borders] == 1 ? "yes" : "no"), col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       if (cursor == options - 2)   setcolour(vwhite, 15);
 
       // Sounds
       top-=spacing;
       if (cursor == options - 1)   setcolour(vwhite, 25);
-      PrintString("Sounds/Volume", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Sounds/Volume", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       sprintf(buffer, "%i", optz[o_volume]);
-      PrintString(optz[o_volume] > 0 ? buffer : "Off", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString(optz[o_volume] > 0 ? buffer : "Off", col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
 
       if (mousefound && optz[o_mouse])
       {
          setcolour(vyellow, 25);
-         PrintString("X", optx, ymax-12, 0, 10, 5, 0, c_align, 0);
-         PrintString("X", optx, -ymax+12, 0, 10, 5, 0, c_align, 0);
-         PrintString("X", xmax-12, opty, 0, 10, 5, 0, c_align, 0);
-         PrintString("X", -xmax+12, opty, 0, 10, 5, 0, c_align, 0);
+         PrintString("X", optx, ymax-12, 0, 10, 5, 0, c_align, optz[o_font]);
+         PrintString("X", optx, -ymax+12, 0, 10, 5, 0, c_align, optz[o_font]);
+         PrintString("X", xmax-12, opty, 0, 10, 5, 0, c_align, optz[o_font]);
+         PrintString("X", -xmax+12, opty, 0, 10, 5, 0, c_align, optz[o_font]);
        }
 
       // Print Keycode
       top=-ymax+50;
       setcolour(vgreen, 20);
-      PrintString("Last keycode", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString("Last keycode", col1, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
       sprintf(buffer,"0x%04x",lastkey);
-      PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, 0);
+      PrintString(buffer, col2, top, 0, optz[o_fontsize], optz[o_fontsize], 0, l_align, optz[o_font]);
 
       if (cc) lastkey = cc;                        // Record keypress
       if (cc) timer = 0;                           // Reset timer if we pressed something
@@ -2587,6 +2844,7 @@ void   EditGamesList(void)
    char        gamename[50], manufname[50];
    int         c_hide, i_game=10, i_gameinc=2, startgame=0, rows=11; // I tried 15 rows but it caused too much flicker, Make sure it's ODD.
    float       width;
+   int         font;
    int         descindex=0, desclen, j=0, ticks=0, LEDtimer=0, maxlen=45;
 
    MouseX = 0;
@@ -2615,6 +2873,8 @@ void   EditGamesList(void)
 
       if ((LEDtimer%60 == 5) || (LEDtimer%60 == 35)) setLEDs(LEDtimer%60 <30 ? C_LED : N_LED);
 
+      font = (vlod_level() >= LOD_SIMPLE) ? 0 : optz[o_font];       // simple font if detail has been dropped
+
       // print [rows] lines of the games list for user to navigate through
       top=300;
       i_game=10;
@@ -2662,13 +2922,13 @@ void   EditGamesList(void)
                gamename[j] = list_print->desc[j+descindex];
             }
             setcolour(colours[c_col][c_sgame], colours[c_int][c_sgame]);
-            PrintString(gamename, 60, top, 0, optz[o_fontsize]+1, optz[o_fontsize]+1, 0, c_align, 0);
+            PrintString(gamename, 60, top, 0, optz[o_fontsize]+1, optz[o_fontsize]+1, 0, c_align, font);
             sprintf(manufname, "(%s)", list_print->manuf);
-            PrintString(">       ", -300, top, 0, 5, 7, 0, c_align, 0);
-            PrintString("{", -305, top, 0, 13, 13, 0, c_align, 0);
+            PrintString(">       ", -300, top, 0, 5, 7, 0, c_align, font);
+            PrintString("{", -305, top, 0, 13, 13, 0, c_align, font);
             setcolour(c_hide, 25);
-            //PrintString((list_print->hidden == 1 ? "   HIDE  " : "   SHOW  "), -305, top, 0, 5.5, 7, 0, c_align, 0);
-            PrintString((list_print->hidden == 1 ? " " : "}"), -307, top, 0, 7, 7, 0, c_align, 0);
+            //PrintString((list_print->hidden == 1 ? "   HIDE  " : "   SHOW  "), -305, top, 0, 5.5, 7, 0, c_align, font);
+            PrintString((list_print->hidden == 1 ? " " : "}"), -307, top, 0, 7, 7, 0, c_align, font);
             list_active=list_print;
             i_gameinc=-i_gameinc;
             if (startgame)
@@ -2682,15 +2942,15 @@ void   EditGamesList(void)
          {
             setcolour(vwhite, i_game);
             //setcolour(vwhite, colours[c_int][c_glist]);
-            PrintString("{", -305, top, 0, 10, 10, 0, c_align, 0);
+            PrintString("{", -305, top, 0, 10, 10, 0, c_align, font);
 
             //setcolour(colours[c_col][c_glist], colours[c_int][c_glist]);
             setcolour(colours[c_col][c_glist], i_game);
-            PrintString(gamename, 60, top, 0, optz[o_fontsize], optz[o_fontsize], 0, c_align, 0);
+            PrintString(gamename, 60, top, 0, optz[o_fontsize], optz[o_fontsize], 0, c_align, font);
 
             setcolour(c_hide, i_game);
-            //PrintString((list_print->hidden == 1 ? "   HIDE  " : "   SHOW  "), -305, top, 0, 4, 5, 0, c_align, 0);
-            PrintString((list_print->hidden == 1 ? " " : "}"), -307, top, 0, 4, 5, 0, c_align, 0);
+            //PrintString((list_print->hidden == 1 ? "   HIDE  " : "   SHOW  "), -305, top, 0, 4, 5, 0, c_align, font);
+            PrintString((list_print->hidden == 1 ? " " : "}"), -307, top, 0, 4, 5, 0, c_align, font);
             i_game+=i_gameinc;
             if (startgame)
             {
@@ -2704,9 +2964,9 @@ void   EditGamesList(void)
          startgame=0;
       }
       setcolour(vwhite, 20);
-      PrintString(manufname, 60, -ymax+120, 0, optz[o_fontsize], optz[o_fontsize], 0, c_align, 0);
+      PrintString(manufname, 60, -ymax+120, 0, optz[o_fontsize], optz[o_fontsize], 0, c_align, font);
       setcolour(vgreen, 20);
-      PrintString("Set/clear autorun game with 1P Start", 0, -ymax+80, 0, optz[o_fontsize], optz[o_fontsize], 0, c_align, 0);
+      PrintString("Set/clear autorun game with 1P Start", 0, -ymax+80, 0, optz[o_fontsize], optz[o_fontsize], 0, c_align, font);
 
       cc=getkey();
       if (cc)
@@ -2826,17 +3086,17 @@ void EditColours(void)
 
       if (index==1)  setcolour(colours[c_col][c_sman], colours[c_int][c_sman]);
       else           setcolour(colours[c_col][c_man], colours[c_int][c_man]);
-      PrintString("Maker", 0, 300, 0, 12, 12, 0, c_align, 0);
+      PrintString("Maker", 0, 300, 0, 12, 12, 0, c_align, optz[o_font]);
 
       setcolour(colours[c_col][c_arrow], colours[c_int][c_arrow]);
-      PrintString(">", 0, 220, 270, 6, 6, 0, l_align, 0);
+      PrintString(">", 0, 220, 270, 6, 6, 0, l_align, optz[o_font]);
       setcolour(colours[c_col][c_arrow], colours[c_int][c_arrow]);
-      PrintString("<", -150, 300, 0, 7, 7, 0, c_align, 0);
-      PrintString(">", 125, 300, 0, 7, 7, 0, c_align, 0);
+      PrintString("<", -150, 300, 0, 7, 7, 0, c_align, optz[o_font]);
+      PrintString(">", 125, 300, 0, 7, 7, 0, c_align, optz[o_font]);
 
       setcolour(colours[c_col][c_pnman], colours[c_int][c_pnman]);
-      PrintString("Prev", -(xmax-100), 300, 0, 6, 6, 0, c_align, 0);
-      PrintString("Next", xmax-100, 300, 0, 6, 6, 0, c_align, 0);
+      PrintString("Prev", -(xmax-100), 300, 0, 6, 6, 0, c_align, optz[o_font]);
+      PrintString("Next", xmax-100, 300, 0, 6, 6, 0, c_align, optz[o_font]);
 
       top=150;
       for (games=1; games<10; games++)
@@ -2844,12 +3104,12 @@ void EditColours(void)
          if (games == 5)
          {
             setcolour(colours[c_col][c_sgame], colours[c_int][c_sgame]);
-            PrintString("Selected Game", 0, top, 0, 6, 6, 0, c_align, 0);
+            PrintString("Selected Game", 0, top, 0, 6, 6, 0, c_align, optz[o_font]);
          }
          else
          {
             setcolour(colours[c_col][c_glist], colours[c_int][c_glist]);
-            PrintString("Game List Item", 0, top, 0, 5, 5, 0, c_align, 0);
+            PrintString("Game List Item", 0, top, 0, 5, 5, 0, c_align, optz[o_font]);
          }
          top -= 35;
       }
@@ -2983,14 +3243,14 @@ void EditColours(void)
       }
 
       setcolour(vwhite, 25);
-      PrintString("< >", -345, -ymax+165, 90, 4, 6, 90, c_align, 0);
+      PrintString("< >", -345, -ymax+165, 90, 4, 6, 90, c_align, optz[o_font]);
       setcolour(vwhite, 20);
 
-      PrintString("Menu Item", -245, -ymax+170, 0, 6, 6, 0, c_align, 0);
+      PrintString("Menu Item", -245, -ymax+170, 0, 6, 6, 0, c_align, optz[o_font]);
       setcolour(vyellow, 25-curscol);
-      PrintString(desc, -150, -ymax+170, 0, 6, 6, 0, l_align, 0);   // Print the name of the selected menu item
+      PrintString(desc, -150, -ymax+170, 0, 6, 6, 0, l_align, optz[o_font]);   // Print the name of the selected menu item
       setcolour(vwhite, 20);
-      PrintString("P1 Start toggles editing colour/intensity", 0, -ymax+130, 0, 6, 6, 0, c_align, 0);
+      PrintString("P1 Start toggles editing colour/intensity", 0, -ymax+130, 0, 6, 6, 0, c_align, optz[o_font]);
 
       sprintf(colval,"<  %i >",item_col);
       sprintf(intval,"<  %i >",item_int);
@@ -2999,16 +3259,16 @@ void EditColours(void)
       if (!ci_toggle)
       {
          setcolour(vgreen, 25);
-         PrintString("Colour value:", -40, -ymax+75, 0, 6, 6, 0, c_align, 0);
+         PrintString("Colour value:", -40, -ymax+75, 0, 6, 6, 0, c_align, optz[o_font]);
          setcolour(vwhite, 25);
-         PrintString(colval, 150, -ymax+75, 0, 6, 6, 0, c_align, 0);
+         PrintString(colval, 150, -ymax+75, 0, 6, 6, 0, c_align, optz[o_font]);
       }
       else
       {
          setcolour(vmagenta, 25);
-         PrintString("Intensity value:", -40, -ymax+75, 0, 6, 6, 0, c_align, 0);
+         PrintString("Intensity value:", -40, -ymax+75, 0, 6, 6, 0, c_align, optz[o_font]);
          setcolour(vwhite, 25);
-         PrintString(intval, 150, -ymax+75, 0, 6, 6, 0, c_align, 0);
+         PrintString(intval, 150, -ymax+75, 0, 6, 6, 0, c_align, optz[o_font]);
       }
       sendframe();
    }
@@ -3064,12 +3324,7 @@ void TestPatterns()
    #ifdef USBDVG
    if (ZVGPresent == 2)
    {
-      char value[16];
-      if (zvgGetOption("bwDisplay", value, sizeof(value)) == 0)
-      {
-         //printf("Is Mono: %s\n", value);
-         mono = (strcmp(value, "true") == 0);
-      }
+      mono = zvgGetCaps()->bwDisplay;
    }
    #else
    if (ZVGPresent == 1)
@@ -3296,21 +3551,3 @@ void BrightnessBars(int x, int y, int height, int colour)
    drawvector(start, end, 0, 0);
 }
 
-
-/******************************************************************
-   Return the number of games in the current list, so we can
-   determine whether the list needs to be scrolled
-*******************************************************************/
-int numofgames(m_node *manlist)
-{
-   int total= 1;
-   g_node *templist = manlist->firstgame;
-   while (templist->next != manlist->firstgame)
-   {
-      total++;
-      templist = templist->next;
-   }
-   return total;
-}
-
-
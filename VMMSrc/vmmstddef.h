@@ -134,10 +134,33 @@ enum options {
    o_volume
 };
 
+// Layers of the menu screen, each redrawn only when it changes
+enum layers {
+   lay_chrome,                   // borders, manufacturer name and arrows
+   lay_logos,                    // manufacturer logos at the sides
+   lay_list,                     // games list
+   NUM_LAYERS
+};
+
 typedef struct {
    float x, y;
 } point;
 
+// A point in a polyline with x of PEN_UP lifts the pen, see drawpolyline()
+#define PEN_UP         (-32768)
+
+/*******************************************************
+A 2x3 affine transform, mapping x,y to
+   x' = a*x + b*y + tx
+   y' = c*x + d*y + ty
+Built once per string or object, so each point drawn
+costs one multiply-add rather than a rotation
+*******************************************************/
+typedef struct {
+   float a, b, c, d;
+   float tx, ty;
+} vmatrix;
+
 /*******************************************************
 Define a vector object, having:
    A vector shape                        (outline)
@@ -0,0 +1,209 @@
+/******************************************************************
+* Vector Mame Menu - Line simplification
+*
+* Small text and shapes have more points in their curves than can
+* be told apart on screen. Each chain of joined segments (the end
+* of one the start of the next) is simplified with the Douglas-
+* Peucker algorithm: the point furthest from the line between the
+* chain's ends is kept if it is further than the tolerance, and
+* the two halves either side of it are simplified the same way.
+* The points left are joined up again.
+*
+* The same chains turn segment lists into polylines, so that each
+* point shared by two segments is only drawn through once.
+*
+* Glyphs and shapes are simplified once, at each of a few
+* tolerances, and the level drawn is picked from how big they are
+* on screen: the coarsest one whose tolerance is still under a
+* screen unit once scaled.
+*
+*******************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "vsimp.h"
+
+#define MAX_CHAIN    256         // longest chain simplified in one go, longer ones are split
+#define SCREEN_TOL   1.0         // screen units a dropped point can be out by
+
+const float vsimp_tol[VSIMP_LEVELS] = {0, 0.5, 1.0, 2.0};
+
+static double  drawn[VSIMP_SIZES], saved[VSIMP_SIZES];
+
+
+/******************************************************************
+   Return the coarsest level that is still within SCREEN_TOL when
+   drawn at scale screen units per unit
+*******************************************************************/
+int vsimp_level(float scale)
+{
+   int l;
+   scale = fabs(scale);
+   for (l = VSIMP_LEVELS - 1; l > 0; l--)
+   {
+      if (vsimp_tol[l] * scale <= SCREEN_TOL) break;
+   }
+   return l;
+}
+
+
+/******************************************************************
+   Distance of point i from the line a to b, or from a if the line
+   is a point (as it is for a closed loop)
+*******************************************************************/
+static float distance(const float *x, const float *y, int a, int b, int i)
+{
+   float dx = x[b] - x[a], dy = y[b] - y[a];
+   float len = sqrt(dx*dx + dy*dy);
+   if (len == 0) return sqrt((x[i] - x[a]) * (x[i] - x[a]) + (y[i] - y[a]) * (y[i] - y[a]));
+   return fabs(dy * (x[i] - x[a]) - dx * (y[i] - y[a])) / len;
+}
+
+
+/******************************************************************
+   Mark the points between a and b to keep
+*******************************************************************/
+static void simplify(const float *x, const float *y, char *kept, int a, int b, float tol)
+{
+   int   i, worst = 0;
+   float d, most = tol;
+   for (i = a + 1; i < b; i++)
+   {
+      d = distance(x, y, a, b, i);
+      if (d > most)
+      {
+         most = d;
+         worst = i;
+      }
+   }
+   if (worst)
+   {
+      kept[worst] = 1;
+      simplify(x, y, kept, a, worst, tol);
+      simplify(x, y, kept, worst, b, tol);
+   }
+}
+
+
+/******************************************************************
+   Return how many segments, from i, are joined end to start
+*******************************************************************/
+static int chain(const int *in, int n, int i)
+{
+   int m = 1;
+   while ((i + m < n) && (m < MAX_CHAIN)
+      && (in[(i + m)*4 + 0] == in[(i + m)*4 - 2]) && (in[(i + m)*4 + 1] == in[(i + m)*4 - 1]))
+   {
+      m++;
+   }
+   return m;
+}
+
+
+/******************************************************************
+   Simplify n segments, 4 ints each (x1, y1, x2, y2), into out
+   which must have room for n. Returns the number of segments in
+   out.
+*******************************************************************/
+int vsimp_segments(const int *in, int n, int *out, float tol)
+{
+   int   i, j, m, k = 0, last;
+   float x[MAX_CHAIN + 1], y[MAX_CHAIN + 1];
+   char  kept[MAX_CHAIN + 1];
+   const int *s;
+
+   for (i = 0; i < n; i += m)
+   {
+      m = chain(in, n, i);
+      if ((tol <= 0) || (m == 1))
+      {
+         for (j = 0; j < m*4; j++) out[k*4 + j] = in[i*4 + j];
+         k += m;
+         continue;
+      }
+      for (j = 0; j < m; j++)
+      {
+         s = &in[(i + j)*4];
+         x[j] = s[0];
+         y[j] = s[1];
+         kept[j] = 0;
+      }
+      x[m] = in[(i + m - 1)*4 + 2];
+      y[m] = in[(i + m - 1)*4 + 3];
+      kept[0] = kept[m] = 1;
+      simplify(x, y, kept, 0, m, tol);
+      for (j = 1, last = 0; j <= m; j++)
+      {
+         if (!kept[j]) continue;
+         out[k*4 + 0] = x[last];
+         out[k*4 + 1] = y[last];
+         out[k*4 + 2] = x[j];
+         out[k*4 + 3] = y[j];
+         k++;
+         last = j;
+      }
+   }
+   return k;
+}
+
+
+/******************************************************************
+   Turn n segments, 4 ints each, into polylines in out, as x,y
+   pairs with a penup,penup pair between one polyline and the
+   next. out needs room for 6n ints. Returns the number of points,
+   pen ups included.
+*******************************************************************/
+int vsimp_strips(const int *in, int n, int *out, int penup)
+{
+   int i, j, m, k = 0;
+   for (i = 0; i < n; i += m)
+   {
+      m = chain(in, n, i);
+      if (i)
+      {
+         out[k*2]     = penup;
+         out[k*2 + 1] = penup;
+         k++;
+      }
+      for (j = 0; j < m; j++, k++)
+      {
+         out[k*2]     = in[(i + j)*4];
+         out[k*2 + 1] = in[(i + j)*4 + 1];
+      }
+      out[k*2]     = in[(i + m)*4 - 2];
+      out[k*2 + 1] = in[(i + m)*4 - 1];
+      k++;
+   }
+   return k;
+}
+
+
+/******************************************************************
+   Count a string drawn at a font size, or a shape for size 0,
+   with the vectors it was drawn with and how many were saved
+*******************************************************************/
+void vsimp_count(int size, int vectors, int fewer)
+{
+   if (size < 0) size = 0;
+   if (size >= VSIMP_SIZES) size = VSIMP_SIZES - 1;
+   drawn[size] += vectors;
+   saved[size] += fewer;
+}
+
+
+/******************************************************************
+   Print the vectors drawn and saved a frame at each font size
+*******************************************************************/
+void vsimp_report(unsigned int frames)
+{
+   int s;
+   if (frames == 0) return;
+   for (s = 0; s < VSIMP_SIZES; s++)
+   {
+      if (drawn[s] + saved[s] == 0) continue;
+      if (s) printf("Simplified text size %2d", s);
+      else printf("Simplified shapes      ");
+      printf(": %.1f vectors/frame, %.1f saved (%.1f%%)\n", drawn[s] / frames, saved[s] / frames,
+         saved[s] * 100.0 / (drawn[s] + saved[s]));
+   }
+}
@@ -0,0 +1,24 @@
+/**************************************
+vsimp.h
+Line simplification, drops detail
+from glyphs and shapes too small on
+screen to show it, and turns them
+into polylines
+Function declarations
+**************************************/
+
+#ifndef _VSIMP_H_
+#define _VSIMP_H_
+
+#define VSIMP_LEVELS 4           // simplification levels, 0 is the shape as drawn
+#define VSIMP_SIZES  32          // font sizes counted separately in the report
+
+extern const float vsimp_tol[VSIMP_LEVELS];                  // furthest a dropped point can be from the line, at each level
+
+int   vsimp_level(float);                                    // level to use at a scale (screen units per shape unit)
+int   vsimp_segments(const int*, int, int*, float);        // simplify a list of segments, returns how many are left
+int   vsimp_strips(const int*, int, int*, int);              // join a list of segments into polylines, returns the points
+void  vsimp_count(int, int, int);                            // count vectors drawn and saved at a font size, 0 for shapes
+void  vsimp_report(unsigned int);                            // print the vectors saved per frame
+
+#endif
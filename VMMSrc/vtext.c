@@ -0,0 +1,141 @@
+/******************************************************************
+* Vector Mame Menu - String cache
+*
+* Most of the strings on screen are the same from one frame to the
+* next, so rather than lay each one out again every frame, the
+* polylines of the most recently printed strings are kept, already
+* scaled, rotated and turned for the screen rotation. They are
+* stored relative to the point the string was printed at, so a
+* string that moves (but is otherwise the same) is still found.
+*
+* A string is looked up by its text and everything that changes
+* its shape. When the cache is full the string used least recently
+* is dropped to make room.
+*
+*******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vtext.h"
+
+typedef struct
+{
+   v_textkey      key;
+   unsigned int   hash;          // hash of the key text, to skip most compares
+   unsigned int   used;          // when last used, 0 if the entry is empty
+   point          *points;       // polylines of the string, see drawpolyline()
+   int            count, size;   // points in the string, and room for
+   int            vectors;       // vectors drawn through the points
+   int            saved;         // vectors simplifying the glyphs saved
+} v_textentry;
+
+static v_textentry   cache[VTEXT_ENTRIES];
+static unsigned int  tick = 0;
+static v_textstats   totals;
+
+
+/******************************************************************
+   FNV-1a hash of a string
+*******************************************************************/
+static unsigned int hash(const char *s)
+{
+   unsigned int h = 2166136261u;
+   while (*s)
+   {
+      h = (h ^ (unsigned char)*s++) * 16777619u;
+   }
+   return h;
+}
+
+
+/******************************************************************
+   See if two keys are for the same string
+*******************************************************************/
+static int samekey(const v_textkey *a, const v_textkey *b)
+{
+   return (a->font == b->font) && (a->xScale == b->xScale) && (a->yScale == b->yScale)
+      && (a->charangle == b->charangle) && (a->lineangle == b->lineangle)
+      && (a->alignment == b->alignment) && (a->rot == b->rot) && !strcmp(a->text, b->text);
+}
+
+
+/******************************************************************
+   Find a string in the cache, returning its points and setting
+   count to how many there are, vectors to how many vectors they
+   draw and saved to how many vectors simplifying saved, or NULL
+   if it isn't there
+*******************************************************************/
+const point* vtext_find(const v_textkey *key, int *count, int *vectors, int *saved)
+{
+   int            i;
+   unsigned int   h = hash(key->text);
+   for (i = 0; i < VTEXT_ENTRIES; i++)
+   {
+      if (cache[i].used && (cache[i].hash == h) && samekey(&cache[i].key, key))
+      {
+         cache[i].used = ++tick;
+         *count   = cache[i].count;
+         *vectors = cache[i].vectors;
+         *saved   = cache[i].saved;
+         totals.hits++;
+         return cache[i].points;
+      }
+   }
+   totals.misses++;
+   return NULL;
+}
+
+
+/******************************************************************
+   Add a string of count points, drawing the given vectors, saved
+   fewer than unsimplified, to the cache in place of the one used
+   least recently. Returns where to put the points.
+*******************************************************************/
+point* vtext_add(const v_textkey *key, int count, int vectors, int saved)
+{
+   int         i;
+   v_textentry *e = &cache[0];
+   point       *p;
+   for (i = 1; i < VTEXT_ENTRIES; i++)
+   {
+      if (cache[i].used < e->used) e = &cache[i];
+   }
+   if ((count > e->size) || (e->points == NULL))
+   {
+      p = realloc(e->points, (count + 1) * sizeof(point));   // never NULL, even for a blank string
+      if (p == NULL)
+      {
+         return NULL;
+      }
+      e->points = p;
+      e->size  = count + 1;
+   }
+   e->key   = *key;
+   e->hash  = hash(key->text);
+   e->used  = ++tick;
+   e->count   = count;
+   e->vectors = vectors;
+   e->saved   = saved;
+   return e->points;
+}
+
+
+/******************************************************************
+   Return the totals collected since startup
+*******************************************************************/
+void vtext_stats(v_textstats *stats)
+{
+   *stats = totals;
+}
+
+
+/******************************************************************
+   Print how well the cache did
+*******************************************************************/
+void vtext_report(void)
+{
+   unsigned int n = totals.hits + totals.misses;
+   if (n == 0) return;
+   printf("String cache: %u hits, %u misses (%.1f%% hit)\n", totals.hits, totals.misses, totals.hits * 100.0 / n);
+}
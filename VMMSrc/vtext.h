@@ -0,0 +1,37 @@
+/**************************************
+vtext.h
+String cache, keeps the vectors of
+recently printed strings ready to draw
+Function declarations
+**************************************/
+
+#ifndef _VTEXT_H_
+#define _VTEXT_H_
+
+#include "vmmstddef.h"
+
+#define VTEXT_LEN     100        // longest string cached, including the terminator
+#define VTEXT_ENTRIES 128        // number of strings cached
+
+typedef struct
+{
+   char  text[VTEXT_LEN];        // string as printed, after any upper casing
+   int   font;
+   float xScale, yScale;
+   int   charangle, lineangle;
+   int   alignment;
+   int   rot;                    // screen rotation
+} v_textkey;
+
+typedef struct
+{
+   unsigned int   hits;          // strings drawn from the cache
+   unsigned int   misses;        // strings laid out and added to it
+} v_textstats;
+
+const point*  vtext_find(const v_textkey*, int*, int*, int*);   // cached polylines for a string, their points, vectors and vectors simplifying saved, NULL if not cached
+point*        vtext_add(const v_textkey*, int, int, int);     // make room for a string's polylines, NULL if out of memory
+void          vtext_stats(v_textstats*);              // totals since startup
+void          vtext_report(void);                     // print the totals
+
+#endif
@@ -9,6 +9,7 @@
 * History:
 * 
 * 100623 Updated for Windows by Steve Johnson
+* 261016 Added tmrGetStats()
 *
 * (c) Copyright 2003-2004, Zektor, LLC.  All Rights Reserved.
 *****************************************************************************/
@@ -34,6 +35,28 @@ extern "C" {
  *
  *************************************************/
 
+// tmrWaitForFrame() sleeps until this long before a frame is due, then spins
+
+#if defined(__WIN32__) || defined(_WIN32)
+#define	TMR_SPIN_US		2000
+#else
+#define	TMR_SPIN_US		500
+#endif
+
+#define	TMR_HIST_US		50			// lateness histogram bucket width, in us
+#define	TMR_HIST_SIZE		200			// lateness histogram buckets, the last holds anything later
+
+// Frame pacing statistics, from 'tmrGetStats()'
+
+typedef struct TMRSTATS_S
+{	int			fps;			// frame rate being paced to
+	unsigned int		frames;			// number of calls to 'tmrWaitForFrame()'
+	unsigned int		missed;			// frame boundaries that passed without a wait
+	long long int		lateSum;		// total lateness past the frame boundaries, in us
+	long long int		lateMax;		// latest wake up, in us
+	long long int		lateP99;		// 99th percentile of the lateness, in us
+} tmrStats_t;
+
 extern int				tmrInit(void);
 extern void				tmrSetFrameRate(int);
 extern unsigned int			tmrNumberFramesSkipped(void);
@@ -43,6 +66,7 @@ extern int				tmrTestTicks( long long int, int);
 extern int				tmrTestMillis( long long int, int);
 extern int				tmrTestFrameCount( unsigned int, unsigned int);
 extern long long int			tmrGetTicksInFrame();
+extern void				tmrGetStats( tmrStats_t *);
 
 #ifdef __cplusplus
 }
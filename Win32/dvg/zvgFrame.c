@@ -8,10 +8,18 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 #include <limits.h>
 
+#ifdef __SSE2__
+   #include <emmintrin.h>
+#endif
+
 #ifdef __WIN32__
+   #ifndef _WIN32_WINNT
+      #define _WIN32_WINNT 0x0600   // Vista or later, for CONDITION_VARIABLE
+   #endif
    #include <windows.h>
 #else
    #include <unistd.h>
@@ -19,6 +27,8 @@
    #include <sys/stat.h>
    #include <fcntl.h>
    #include <termios.h>
+   #include <poll.h>
+   #include <pthread.h>
 #endif
 
 #include "zvgFrame.h"
@@ -26,7 +36,8 @@
 //#include "timer.h"
 
 #define ARRAY_SIZE(a)           (sizeof(a)/sizeof((a)[0]))
-#define CMD_BUF_SIZE            0x20000
+#define CMD_BUF_SIZE            0x20000     // larger frames are sent in several packets of this size
+#define CMD_BUF_COUNT           2           // number of frame buffers shared with the writer thread
 #define FLAG_COMPLETE           0x0
 #define FLAG_RGB                0x1
 #define FLAG_XY                 0x2
@@ -34,6 +45,12 @@
 #define FLAG_CMD                0x5
 #define FLAG_CMD_GET_DVG_INFO   0x1
 
+#define SERIAL_TIMEOUT_MS       500         // longest wait for a single read to complete
+#define SERIAL_QUIET_MS         20          // input must be idle this long to count as drained
+#define SERIAL_DRAIN_MS         1000        // give up draining stale input after this long
+#define DVG_INFO_RETRIES        5           // attempts at the GET_DVG_INFO handshake
+#define DVG_REPEAT_REFRESH      45          // resend an unchanged frame at least this often
+
 #define DVG_RES_MIN             0
 #define DVG_RES_MAX             4095
 
@@ -53,8 +70,21 @@ extern int g_debug;
 
 
 static int     s_cmd_offs;
-static uint8_t s_cmd_buf[CMD_BUF_SIZE];
+static uint8_t s_cmd_bufs[CMD_BUF_COUNT][CMD_BUF_SIZE];
+static uint8_t *s_cmd_buf = s_cmd_bufs[0];   // buffer the current frame is being built in
+static int     s_cmd_idx;                    // index of s_cmd_buf within s_cmd_bufs
+static int     s_cmd_sync;                   // length of the sync pattern at the start of s_cmd_buf
+static int     s_cmd_split;                  // frame being built has already had a packet sent
+static uint32_t s_split_frames;              // frames too large for one buffer, sent in packets
+static int     s_sent_idx = -1;              // buffer holding the last frame sent, -1 if none
+static int     s_sent_sync;
+static int     s_sent_len;
+static int     s_repeat_next;                // next zvgFrameSend() repeats the last frame
+static int     s_repeat_count;               // consecutive repeats not written to the DVG
+static uint32_t s_saved_frames;              // unchanged frames repeated rather than built
+static uint32_t s_saved_bytes;               // bytes of those not written to the DVG
 static uint8_t s_last_r, s_last_g, s_last_b;
+static int     s_rgb_sent;                   // colour last sent this frame as 0xRRGGBB, -1 if none yet
 static int     s_last_x;
 static int     s_last_y;
 #if defined(linux) || defined(__linux)
@@ -66,9 +96,34 @@ static HANDLE  s_serial_fd = INVALID_HANDLE_VALUE;
 static char    s_serial_dev[128];
 static int     s_xmin, s_xmax;
 static int     s_ymin, s_ymax;
+static int     s_clip_inside;                // clip window lies within X_MIN..X_MAX, Y_MIN..Y_MAX
 extern char    DVGPort[15];
 static char    s_json_buf[512];
 static int     s_json_length;
+static dvg_caps_t s_caps;                    // decoded s_json_buf, valid until the port is closed
+
+// Writer thread state. Frames are handed off in the order they were built,
+// s_tx_queued counts the buffers waiting for, or currently being written.
+static int     s_tx_len[CMD_BUF_COUNT];
+static int     s_tx_queued;
+static int     s_tx_running;
+static int     s_tx_error;
+static uint32_t s_tx_stalls;                 // times the menu had to wait for a free buffer
+static long long int s_tx_stall_time;        // timer ticks spent waiting
+#ifdef __WIN32__
+static HANDLE             s_tx_thread;
+static CRITICAL_SECTION   s_tx_lock;
+static CONDITION_VARIABLE s_tx_cond;
+#else
+static pthread_t          s_tx_thread;
+static pthread_mutex_t    s_tx_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t     s_tx_cond = PTHREAD_COND_INITIALIZER;
+#endif
+
+static int serial_write(void *buf, uint32_t size);
+static int tx_queue(void);
+static int dvg_handshake(void);
+static void caps_parse(void);
 
 enum portErrCode
 {  errOk = 0,           // no error (must be set to 0)
@@ -87,6 +142,7 @@ static void cmd_reset(uint32_t initial)
    s_cmd_offs = 0;
    s_last_x = s_last_y = INT_MIN;
    s_last_r = s_last_g = s_last_b = 0;
+   s_rgb_sent = -1;
    // Special sync pattern
    cnt = 8;
    if (initial) {
@@ -95,6 +151,260 @@ static void cmd_reset(uint32_t initial)
    for (i = 0 ; i < cnt ; i++) {
       s_cmd_buf[s_cmd_offs++] = 0xc0 | (i & 0x3);
    }
+   s_cmd_sync = cnt;
+}
+
+
+/******************************************************************
+   The buffer is full but the frame isn't. Send what there is as
+   one packet and carry on building the frame in the next buffer.
+   The DVG only draws once it sees FLAG_COMPLETE, so it doesn't
+   matter how the commands are split up on the way.
+*******************************************************************/
+static void cmd_packet(void)
+{
+   if (!s_cmd_split)
+   {
+      s_cmd_split = 1;
+      s_split_frames++;
+   }
+   s_sent_idx = -1;              // the last frame is about to be overwritten
+   tx_queue();
+   s_cmd_offs = 0;
+   s_cmd_sync = 0;
+}
+
+
+/******************************************************************
+   Append a command to the buffer, always leaving room for the
+   FLAG_COMPLETE that ends the frame
+*******************************************************************/
+static void cmd_put(uint32_t cmd)
+{
+   if (s_cmd_offs > (CMD_BUF_SIZE - 8))
+   {
+      cmd_packet();
+   }
+   s_cmd_buf[s_cmd_offs++] = cmd >> 24;
+   s_cmd_buf[s_cmd_offs++] = cmd >> 16;
+   s_cmd_buf[s_cmd_offs++] = cmd >>  8;
+   s_cmd_buf[s_cmd_offs++] = cmd >>  0;
+}
+
+
+/******************************************************************
+   Send the colour set by zvgFrameSetRGB15(), unless the DVG has it
+   already. Called just before a vector is drawn, so colours that
+   no vector uses never go out at all.
+*******************************************************************/
+static void rgb_put(void)
+{
+   int rgb = (s_last_r << 16) | (s_last_g << 8) | s_last_b;
+   if (rgb != s_rgb_sent)
+   {
+      cmd_put((FLAG_RGB << 29) | rgb);
+      s_rgb_sent = rgb;
+   }
+}
+
+
+/******************************************************************
+   Note the frame in s_cmd_buf is being sent
+*******************************************************************/
+static void frame_sent(void)
+{
+   // Only the tail of a frame sent in packets is left in s_cmd_buf,
+   // so there's nothing to compare the next frame against
+   s_sent_idx     = s_cmd_split ? -1 : s_cmd_idx;
+   s_sent_sync    = s_cmd_sync;
+   s_sent_len     = s_cmd_offs;
+   s_repeat_count = 0;
+   s_cmd_split    = 0;
+}
+
+
+/******************************************************************
+   Writer thread locking primitives
+*******************************************************************/
+static void tx_lock(void)
+{
+#ifdef __WIN32__
+   EnterCriticalSection(&s_tx_lock);
+#else
+   pthread_mutex_lock(&s_tx_lock);
+#endif
+}
+
+static void tx_unlock(void)
+{
+#ifdef __WIN32__
+   LeaveCriticalSection(&s_tx_lock);
+#else
+   pthread_mutex_unlock(&s_tx_lock);
+#endif
+}
+
+static void tx_wait(void)
+{
+#ifdef __WIN32__
+   SleepConditionVariableCS(&s_tx_cond, &s_tx_lock, INFINITE);
+#else
+   pthread_cond_wait(&s_tx_cond, &s_tx_lock);
+#endif
+}
+
+static void tx_signal(void)
+{
+#ifdef __WIN32__
+   WakeAllConditionVariable(&s_tx_cond);
+#else
+   pthread_cond_broadcast(&s_tx_cond);
+#endif
+}
+
+
+/******************************************************************
+   Writer thread. Drains queued frame buffers to the serial port
+   so the menu can build the next frame while this one is sent.
+*******************************************************************/
+#ifdef __WIN32__
+static DWORD WINAPI tx_thread(LPVOID arg)
+#else
+static void *tx_thread(void *arg)
+#endif
+{
+   int idx, ok;
+   (void)arg;
+
+   tx_lock();
+   while (1)
+   {
+      while (s_tx_running && s_tx_queued == 0)
+      {
+         tx_wait();
+      }
+      if (s_tx_queued == 0)
+      {
+         break;                  // stopped and nothing left to send
+      }
+      // Oldest queued buffer sits s_tx_queued slots behind the build buffer
+      idx = (s_cmd_idx + CMD_BUF_COUNT - s_tx_queued) % CMD_BUF_COUNT;
+      tx_unlock();
+      ok = serial_write(s_cmd_bufs[idx], s_tx_len[idx]);
+      tx_lock();
+      if (!ok)
+      {
+         s_tx_error = 1;         // tx_queue() reads and clears it under the lock
+      }
+      s_tx_queued--;
+      tx_signal();
+   }
+   tx_unlock();
+   return 0;
+}
+
+
+/******************************************************************
+   Start the writer thread
+*******************************************************************/
+static int tx_start(void)
+{
+   s_tx_queued  = 0;
+   s_tx_error   = 0;
+   s_tx_stalls  = 0;
+   s_tx_stall_time = 0;
+   s_split_frames = 0;
+   s_tx_running = 1;
+#ifdef __WIN32__
+   InitializeCriticalSection(&s_tx_lock);
+   InitializeConditionVariable(&s_tx_cond);
+   s_tx_thread = CreateThread(NULL, 0, tx_thread, NULL, 0, NULL);
+   if (s_tx_thread == NULL)
+#else
+   if (pthread_create(&s_tx_thread, NULL, tx_thread, NULL) != 0)
+#endif
+   {
+      s_tx_running = 0;
+      return 0;
+   }
+   return 1;
+}
+
+
+/******************************************************************
+   Wait until every queued frame has been written
+*******************************************************************/
+static void tx_flush(void)
+{
+   if (!s_tx_running)
+   {
+      return;
+   }
+   tx_lock();
+   while (s_tx_queued)
+   {
+      tx_wait();
+   }
+   tx_unlock();
+}
+
+
+/******************************************************************
+   Drain the queue and stop the writer thread
+*******************************************************************/
+static void tx_stop(void)
+{
+   if (!s_tx_running)
+   {
+      return;
+   }
+   tx_lock();
+   s_tx_running = 0;
+   tx_signal();
+   tx_unlock();
+#ifdef __WIN32__
+   WaitForSingleObject(s_tx_thread, INFINITE);
+   CloseHandle(s_tx_thread);
+   DeleteCriticalSection(&s_tx_lock);
+#else
+   pthread_join(s_tx_thread, NULL);
+#endif
+   #ifdef DEBUG
+      printf("DVG: waited for the writer thread on %u frames\n", s_tx_stalls);
+      printf("DVG: %u frames were sent in more than one packet\n", s_split_frames);
+   #endif
+}
+
+
+/******************************************************************
+   Throw away anything the DVG sent before we were listening.
+   Waits for the input to go quiet rather than for a fixed time.
+*******************************************************************/
+static void serial_drain(void)
+{
+#ifdef __WIN32__
+   PurgeComm(s_serial_fd, PURGE_RXCLEAR | PURGE_TXCLEAR);
+#else
+   struct pollfd pfd;
+   uint8_t       junk[256];
+   long long int start;
+
+   start      = tmrReadTimer();
+   pfd.fd     = s_serial_fd;
+   pfd.events = POLLIN;
+   while (!tmrTestMillis(start, SERIAL_DRAIN_MS))
+   {
+      if (poll(&pfd, 1, SERIAL_QUIET_MS) <= 0)
+      {
+         break;
+      }
+      if (read(s_serial_fd, junk, sizeof(junk)) <= 0)
+      {
+         break;
+      }
+   }
+   tcflush(s_serial_fd, TCIOFLUSH);
+#endif
 }
 
 
@@ -140,12 +450,14 @@ static int serial_open()
          goto END;
       }
       memset(&timeouts, 0, sizeof(COMMTIMEOUTS));
+      timeouts.ReadTotalTimeoutConstant = SERIAL_TIMEOUT_MS;
       res= SetCommTimeouts(s_serial_fd, &timeouts);
       if (res == FALSE)
       {
          zvgError(errSetComTimeout);
          goto END;
       }
+      serial_drain();
       result = 0;
    #else                   // Linux Code
       struct termios attr;
@@ -161,11 +473,33 @@ static int serial_open()
       attr.c_cflag |= (CLOCAL | CREAD);
       attr.c_oflag &= ~OPOST;
       tcsetattr(s_serial_fd, TCSAFLUSH, &attr);
-      sleep(2); //required to make flush work, for some reason
-      tcflush(s_serial_fd, TCIOFLUSH);
+      serial_drain();
       result = 0;
    #endif
+   // The DVG may have been changed while we were away (RunGame), so
+   // the info is read afresh every time the port is opened
+   memset(&s_caps, 0, sizeof(s_caps));
+   // The DVG may still be booting after the port was opened, so don't
+   // start streaming frames until it has answered an info request
+   if (result == 0)
+   {
+      if (!dvg_handshake())
+      {
+         printf("DVG: no reply to info request, continuing anyway\n");
+         s_json_length = 0;
+      }
+      caps_parse();
+   }
+   if (result == 0 && !tx_start())
+   {
+      printf("DVG: could not start writer thread, sending frames synchronously\n");
+   }
    END:
+   s_cmd_idx   = 0;
+   s_cmd_buf   = s_cmd_bufs[0];
+   s_sent_idx  = -1;
+   s_repeat_next = 0;
+   s_cmd_split = 0;
    cmd_reset(1);
    return result;
 }
@@ -201,30 +535,49 @@ END:
 
 
 /******************************************************************
-   Read from the serial port
+   Read from the serial port.  Waits at most timeout_ms for all
+   size bytes to arrive, returns non-zero only if they all did.
 *******************************************************************/
-static int serial_read(void *buf, uint32_t size)
+static int serial_read(void *buf, uint32_t size, int timeout_ms)
 {
-    int result = -1;
+    uint8_t      *p = buf;
+    uint32_t      got = 0;
 #ifdef __WIN32__
-    DWORD read;
-    if (ReadFile(s_serial_fd, buf, size, &read, NULL))
+    DWORD         read;
+    // The port read timeout is set to SERIAL_TIMEOUT_MS in serial_open()
+    (void)timeout_ms;
+    while (got < size)
     {
-        result = read;
+        if (!ReadFile(s_serial_fd, p + got, size - got, &read, NULL) || read == 0)
+        {
+            break;
+        }
+        got += read;
     }
 #else
-    /**
-     * Calling read() immediately will return 0 bytes if called after a write.
-     * The sleep is used to give the DVG some time to process the command.
-     * TODO: find a better solution.
-    */
-    sleep(2); // see above
-    result = read(s_serial_fd, buf, size);
-    if (result != (int)size) {
-        printf("DVG: read error %d \n", result);
+    struct pollfd pfd;
+    long long int start;
+    int           wait, n;
+
+    start      = tmrReadTimer();
+    pfd.fd     = s_serial_fd;
+    pfd.events = POLLIN;
+    while (got < size)
+    {
+        wait = timeout_ms - (int)((tmrReadTimer() - start) / 1000000);
+        if (wait <= 0 || poll(&pfd, 1, wait) <= 0)
+        {
+            break;
+        }
+        n = read(s_serial_fd, p + got, size - got);
+        if (n <= 0)
+        {
+            break;
+        }
+        got += n;
     }
 #endif
-    return result > 0;
+    return got == size;
 }
 
 
@@ -235,6 +588,7 @@ static int serial_close()
 {
    int result = -1;
    uint32_t cmd;
+   tx_stop();
    if (s_serial_fd != INVALID_HANDLE_VALUE)
    {
       // Be gentle and indicate to USB-DVG that it is game over!
@@ -257,6 +611,35 @@ static int serial_close()
 }
 
 
+/******************************************************************
+   Repeat the last frame sent, see zvgFrameRepeat(). The DVG keeps
+   redrawing the last complete frame it received, so the frame only
+   goes out again now and then in case the board missed it, copied
+   from the buffer it was sent from rather than built again.
+*******************************************************************/
+static int frame_repeat(void)
+{
+   int   result, len;
+
+   s_repeat_next = 0;
+   s_saved_frames++;
+   if (s_repeat_count < DVG_REPEAT_REFRESH)
+   {
+      s_repeat_count++;
+      s_saved_bytes += s_sent_len;
+      return 1;
+   }
+   // Nothing but the sync pattern has been put in s_cmd_buf
+   len = s_sent_len - s_sent_sync;
+   memcpy(s_cmd_buf + s_cmd_offs, s_cmd_bufs[s_sent_idx] + s_sent_sync, len);
+   s_cmd_offs += len;
+   frame_sent();
+   result = tx_queue();
+   cmd_reset(0);
+   return result;
+}
+
+
 /******************************************************************
    Send data to the serial port
 *******************************************************************/
@@ -265,17 +648,63 @@ static int serial_send()
    int      result = -1;
    uint32_t cmd;
 
+   if (s_repeat_next)
+   {
+      return frame_repeat();
+   }
    cmd = (FLAG_COMPLETE << 29);
    s_cmd_buf[s_cmd_offs++] = cmd >> 24;
    s_cmd_buf[s_cmd_offs++] = cmd >> 16;
    s_cmd_buf[s_cmd_offs++] = cmd >>  8;
    s_cmd_buf[s_cmd_offs++] = cmd >>  0;
-   result = serial_write(s_cmd_buf, s_cmd_offs);
+   frame_sent();
+   result = tx_queue();
    cmd_reset(0);
    return result;
 }
 
 
+/******************************************************************
+   Hand the buffer to the writer thread and move on to the next
+   one, waiting only if the writer still owns it
+*******************************************************************/
+static int tx_queue(void)
+{
+   int      result;
+   long long int start;
+
+   if (!s_tx_running)
+   {
+      // Still alternate buffers so the last frame is kept to be repeated
+      result = serial_write(s_cmd_buf, s_cmd_offs);
+      s_cmd_idx = (s_cmd_idx + 1) % CMD_BUF_COUNT;
+      s_cmd_buf = s_cmd_bufs[s_cmd_idx];
+      return result;
+   }
+
+   tx_lock();
+   s_tx_len[s_cmd_idx] = s_cmd_offs;
+   s_tx_queued++;
+   tx_signal();
+   s_cmd_idx = (s_cmd_idx + 1) % CMD_BUF_COUNT;
+   if (s_tx_queued >= CMD_BUF_COUNT)
+   {
+      s_tx_stalls++;
+      start = tmrReadTimer();
+      while (s_tx_queued >= CMD_BUF_COUNT)
+      {
+         tx_wait();
+      }
+      s_tx_stall_time += tmrReadTimer() - start;
+   }
+   result = !s_tx_error;
+   s_tx_error = 0;
+   tx_unlock();
+   s_cmd_buf = s_cmd_bufs[s_cmd_idx];
+   return result;
+}
+
+
 /******************************************************************
    Function to compute region code for a point(x, y)
 *******************************************************************/
@@ -394,71 +823,233 @@ static uint32_t line_clip(int32_t *pX1, int32_t *pY1, int32_t *pX2, int32_t *pY2
 }
 
 /******************************************************************
-   Get DVG Info
+   Ask the DVG for its info block and wait for the reply.  Doubles
+   as the readiness check after opening the port, so it retries a
+   few times before giving up.
 *******************************************************************/
-static void get_dvg_info()
+static int dvg_handshake(void)
 {
-    uint32_t cmd;
-    uint8_t cmd_buf[4];
+    uint32_t cmd, reply;
+    uint8_t  cmd_buf[4];
+    int      attempt, length;
 
-    if (s_json_length) {
-        return;
-    }
     cmd = (FLAG_CMD << 29) | FLAG_CMD_GET_DVG_INFO;
     cmd_buf[0] = cmd >> 24;
     cmd_buf[1] = cmd >> 16;
     cmd_buf[2] = cmd >> 8;
     cmd_buf[3] = cmd >> 0;
-    serial_write(cmd_buf, 4);
-    serial_read(&cmd, sizeof(cmd));
-    serial_read(&s_json_length, sizeof(s_json_length));
-    s_json_length = MIN(s_json_length, sizeof(s_json_buf) - 1);
-    serial_read(s_json_buf, s_json_length);
+    for (attempt = 0; attempt < DVG_INFO_RETRIES; attempt++)
+    {
+        if (attempt)
+        {
+            serial_drain();     // discard any partial reply before asking again
+        }
+        if (!serial_write(cmd_buf, 4))
+        {
+            continue;
+        }
+        if (!serial_read(&reply, sizeof(reply), SERIAL_TIMEOUT_MS))
+        {
+            continue;
+        }
+        if (!serial_read(&length, sizeof(length), SERIAL_TIMEOUT_MS))
+        {
+            continue;
+        }
+        if (length <= 0)
+        {
+            continue;
+        }
+        length = MIN(length, sizeof(s_json_buf) - 1);
+        if (!serial_read(s_json_buf, length, SERIAL_TIMEOUT_MS))
+        {
+            continue;
+        }
+        s_json_buf[length] = 0;
+        s_json_length = length;
+        return 1;
+    }
+    return 0;
 }
 
-static int jsoneq(const char *json, jsmntok_t *tok, const char *s) {
-    if (tok->type == JSMN_STRING && (int)strlen(s) == tok->end - tok->start &&
-        strncmp(json + tok->start, s, tok->end - tok->start) == 0) {
-        return 0;
-    }
-    return -1;
+
+/******************************************************************
+   Copy a JSON token's text into a buffer
+*******************************************************************/
+static void json_copy(const char *json, jsmntok_t *tok, char *buf, int size)
+{
+    int len = MIN(tok->end - tok->start, size - 1);
+    memcpy(buf, json + tok->start, len);
+    buf[len] = 0;
 }
 
 
 /******************************************************************
-   Get DVG Option
+   JSON true/false (or a number) to an int
 *******************************************************************/
-int zvgGetOption(char *option, char *val_buf, uint32_t val_buf_size)
+static int json_bool(const char *value)
 {
-    int result = -1;
-    jsmntok_t t[128];
+    if (strcmp(value, "true") == 0) return 1;
+    if (strcmp(value, "false") == 0) return 0;
+    return atoi(value) != 0;
+}
+
+
+/******************************************************************
+   Decode the DVG info block into s_caps.  Only called after a
+   fresh reply, so the JSON is parsed once per open.
+*******************************************************************/
+static void caps_parse(void)
+{
+    jsmntok_t   t[128];
     jsmn_parser p;
-    int         r, i;
+    char        key[DVG_KEY_SIZE], value[DVG_VALUE_SIZE];
+    int         r, i, end;
 
-    get_dvg_info();
+    memset(&s_caps, 0, sizeof(s_caps));
+    s_caps.valid = 1;               // even if broken, don't ask again until reopened
+    if (s_json_length == 0) {
+        return;
+    }
     jsmn_init(&p);
-    r = jsmn_parse(&p, s_json_buf, strlen(s_json_buf), t, ARRAY_SIZE(t));
+    r = jsmn_parse(&p, s_json_buf, s_json_length, t, ARRAY_SIZE(t));
     if (r < 0) {
         printf("Error - Failed to parse JSON: %d\n", r);
-        goto END;
+        return;
     }
     if (r < 1 || t[0].type != JSMN_OBJECT) {
         printf("Error - JSON object expected.\n");
-        goto END;
+        return;
     }
-    for (i = 1; i < r; i++) {
-        if (jsoneq(s_json_buf, &t[i], option) == 0) {
-            int  size;
-            size = t[i + 1].end - t[i + 1].start + 1;
-            size = MIN(size, val_buf_size);
-            strncpy(val_buf, s_json_buf + t[i + 1].start, size);
-            val_buf[size - 1] = 0;
-            result = 0;
-            break;
+    for (i = 1; i + 1 < r; )
+    {
+        json_copy(s_json_buf, &t[i], key, sizeof(key));
+        json_copy(s_json_buf, &t[i + 1], value, sizeof(value));
+        if (strcmp(key, "version") == 0)
+        {
+            strcpy(s_caps.version, value);
+            s_caps.have |= DVG_HAVE_VERSION;
+        }
+        else if (strcmp(key, "flipx") == 0)
+        {
+            s_caps.flipx = json_bool(value);
+            s_caps.have |= DVG_HAVE_FLIPX;
+        }
+        else if (strcmp(key, "flipy") == 0)
+        {
+            s_caps.flipy = json_bool(value);
+            s_caps.have |= DVG_HAVE_FLIPY;
+        }
+        else if (strcmp(key, "swapxy") == 0)
+        {
+            s_caps.swapxy = json_bool(value);
+            s_caps.have |= DVG_HAVE_SWAPXY;
+        }
+        else if (strcmp(key, "bwDisplay") == 0)
+        {
+            s_caps.bwDisplay = json_bool(value);
+            s_caps.have |= DVG_HAVE_BWDISPLAY;
         }
+        else if (strcmp(key, "crtSpeed") == 0)
+        {
+            s_caps.crtSpeed = atoi(value);
+            s_caps.have |= DVG_HAVE_CRTSPEED;
+        }
+        else if (strcmp(key, "defaultGame") == 0)
+        {
+            strcpy(s_caps.defaultGame, value);
+            s_caps.have |= DVG_HAVE_DEFAULTGAME;
+        }
+        else if (s_caps.extra_count < DVG_CAPS_EXTRA)
+        {
+            strcpy(s_caps.extra[s_caps.extra_count].key, key);
+            strcpy(s_caps.extra[s_caps.extra_count].value, value);
+            s_caps.extra_count++;
+        }
+        // step over the value, and anything nested inside it
+        end = t[i + 1].end;
+        for (i += 2; i < r && t[i].start < end; i++);
     }
-END:
-    return result;
+}
+
+
+/******************************************************************
+   Get DVG Info
+*******************************************************************/
+static void get_dvg_info()
+{
+    if (s_caps.valid) {
+        return;
+    }
+    tx_flush();                 // don't interleave with a frame still being sent
+    if (!dvg_handshake())
+    {
+        printf("DVG: read error, no reply to info request\n");
+        s_json_length = 0;
+    }
+    caps_parse();
+}
+
+
+/******************************************************************
+   Get the DVG capabilities, reading them from the DVG if they have
+   not been read since it was opened
+*******************************************************************/
+const dvg_caps_t *zvgGetCaps(void)
+{
+    get_dvg_info();
+    return &s_caps;
+}
+
+
+/******************************************************************
+   Get DVG Option as a string
+*******************************************************************/
+int zvgGetOption(char *option, char *val_buf, uint32_t val_buf_size)
+{
+    const dvg_caps_t *caps;
+    char        value[DVG_VALUE_SIZE];
+    int         i;
+
+    if (val_buf_size == 0) {
+        return -1;
+    }
+    caps = zvgGetCaps();
+    if (strcmp(option, "version") == 0 && (caps->have & DVG_HAVE_VERSION)) {
+        strcpy(value, caps->version);
+    }
+    else if (strcmp(option, "flipx") == 0 && (caps->have & DVG_HAVE_FLIPX)) {
+        strcpy(value, caps->flipx ? "true" : "false");
+    }
+    else if (strcmp(option, "flipy") == 0 && (caps->have & DVG_HAVE_FLIPY)) {
+        strcpy(value, caps->flipy ? "true" : "false");
+    }
+    else if (strcmp(option, "swapxy") == 0 && (caps->have & DVG_HAVE_SWAPXY)) {
+        strcpy(value, caps->swapxy ? "true" : "false");
+    }
+    else if (strcmp(option, "bwDisplay") == 0 && (caps->have & DVG_HAVE_BWDISPLAY)) {
+        strcpy(value, caps->bwDisplay ? "true" : "false");
+    }
+    else if (strcmp(option, "crtSpeed") == 0 && (caps->have & DVG_HAVE_CRTSPEED)) {
+        sprintf(value, "%d", caps->crtSpeed);
+    }
+    else if (strcmp(option, "defaultGame") == 0 && (caps->have & DVG_HAVE_DEFAULTGAME)) {
+        strcpy(value, caps->defaultGame);
+    }
+    else {
+        for (i = 0; i < caps->extra_count; i++) {
+            if (strcmp(option, caps->extra[i].key) == 0) {
+                break;
+            }
+        }
+        if (i == caps->extra_count) {
+            return -1;
+        }
+        strcpy(value, caps->extra[i].value);
+    }
+    strncpy(val_buf, value, val_buf_size - 1);
+    val_buf[val_buf_size - 1] = 0;
+    return 0;
 }
 
 /******************************************************************
@@ -497,7 +1088,8 @@ int zvgFrameOpen(void)
 {
    int result = errOpenDevice;
    tmrInit();                   // initialize timers
-   tmrSetFrameRate(45);         // set the frame rate
+   if (tmrGetTicksInFrame() == 0)
+      tmrSetFrameRate(45);      // set the frame rate, unless it was set before a reopen
    strncpy(s_serial_dev, DVGPort, ARRAY_SIZE(s_serial_dev) - 1);
    s_serial_dev[ARRAY_SIZE(s_serial_dev) - 1] = 0;
    result = serial_open();
@@ -511,6 +1103,7 @@ int zvgFrameOpen(void)
 void zvgFrameClose( void)
 {
     serial_close();
+    memset(&s_caps, 0, sizeof(s_caps));
 }
 
 
@@ -523,6 +1116,7 @@ void zvgFrameSetClipWin( int xMin, int yMin, int xMax, int yMax)
     s_ymin = yMin;
     s_xmax = xMax;
     s_ymax = yMax;
+    s_clip_inside = (xMin >= X_MIN) && (xMax <= X_MAX) && (yMin >= Y_MIN) && (yMax <= Y_MAX);
 }
 
 /******************************************************************
@@ -530,7 +1124,6 @@ void zvgFrameSetClipWin( int xMin, int yMin, int xMax, int yMax)
 *******************************************************************/
 void zvgFrameSetRGB15( uint8_t red, uint8_t green, uint8_t blue)
 {
-   uint32_t cmd;
    uint16_t r, g, b;
 
    // Menu uses 5 bit colour (0-31) so we multiply by 8 to make it 8 bit (0-248)
@@ -541,18 +1134,10 @@ void zvgFrameSetRGB15( uint8_t red, uint8_t green, uint8_t blue)
    b = blue << 3;
    if (b > 255) b = 255;
 
+   // The colour command goes out with the next vector drawn, see rgb_put()
    s_last_r = r;
    s_last_g = g;
    s_last_b = b;
-
-   cmd = (FLAG_RGB << 29) | ((r & 0xff) << 16) | ((g & 0xff) << 8)| (b & 0xff);
-   if (s_cmd_offs <= (CMD_BUF_SIZE - 8))
-   {
-      s_cmd_buf[s_cmd_offs++] = cmd >> 24;
-      s_cmd_buf[s_cmd_offs++] = cmd >> 16;
-      s_cmd_buf[s_cmd_offs++] = cmd >>  8;
-      s_cmd_buf[s_cmd_offs++] = cmd >>  0;
-   }
 }
 
 
@@ -606,28 +1191,17 @@ uint32_t zvgFrameVector( int xStart, int yStart, int xEnd, int yEnd)
       }
 
 
+      rgb_put();
       if ((xs != s_last_x) || (ys != s_last_y))
       {
          blank = 1;
          cmd = (FLAG_XY << 29) | ((blank & 0x1) << 28) | ((xs & 0x3fff) << 14) | (ys & 0x3fff);
-         if (s_cmd_offs <= (CMD_BUF_SIZE - 8))
-         {
-            s_cmd_buf[s_cmd_offs++] = cmd >> 24;
-            s_cmd_buf[s_cmd_offs++] = cmd >> 16;
-            s_cmd_buf[s_cmd_offs++] = cmd >>  8;
-            s_cmd_buf[s_cmd_offs++] = cmd >>  0;
-         }
+         cmd_put(cmd);
       }
 
       blank = ((s_last_r == 0) && (s_last_g == 0) && (s_last_b == 0));
       cmd   = (FLAG_XY << 29) | ((blank & 0x1) << 28) | ((xe & 0x3fff) << 14) | (ye & 0x3fff);
-      if (s_cmd_offs <= (CMD_BUF_SIZE - 8))
-      {
-         s_cmd_buf[s_cmd_offs++] = cmd >> 24;
-         s_cmd_buf[s_cmd_offs++] = cmd >> 16;
-         s_cmd_buf[s_cmd_offs++] = cmd >>  8;
-         s_cmd_buf[s_cmd_offs++] = cmd >>  0;
-      }
+      cmd_put(cmd);
       s_last_x = xe;
       s_last_y = ye;
    }
@@ -635,6 +1209,131 @@ uint32_t zvgFrameVector( int xStart, int yStart, int xEnd, int yEnd)
 }
 
 
+/******************************************************************
+   If a vector lies wholly inside the clip window, convert its
+   coordinates to DVG resolution and return 1.  Otherwise return 0
+   and leave it to zvgFrameVector() to clip.
+
+   (x - X_MIN) * 4095 is below 2^24 so it's exact as a float, and
+   the rounded quotient can never reach the next whole number, so
+   truncating gives the same result as the integer CONVX/CONVY.
+*******************************************************************/
+static int conv_inside(const vec_t *v, int *c)
+{
+#ifdef __SSE2__
+   __m128i p, out;
+   __m128  f;
+
+   p   = _mm_loadu_si128((const __m128i *)v);
+   out = _mm_or_si128(_mm_cmplt_epi32(p, _mm_set_epi32(s_ymin, s_xmin, s_ymin, s_xmin)),
+                      _mm_cmpgt_epi32(p, _mm_set_epi32(s_ymax, s_xmax, s_ymax, s_xmax)));
+   if (_mm_movemask_epi8(out))
+   {
+      return 0;
+   }
+   f = _mm_cvtepi32_ps(_mm_sub_epi32(p, _mm_set_epi32(Y_MIN, X_MIN, Y_MIN, X_MIN)));
+   f = _mm_mul_ps(f, _mm_set1_ps((float)DVG_RES_MAX));
+   f = _mm_div_ps(f, _mm_set_ps(Y_MAX - Y_MIN, X_MAX - X_MIN, Y_MAX - Y_MIN, X_MAX - X_MIN));
+   _mm_storeu_si128((__m128i *)c, _mm_cvttps_epi32(f));
+#else
+   if ((v->xStart < s_xmin) || (v->xStart > s_xmax) || (v->xEnd < s_xmin) || (v->xEnd > s_xmax) ||
+       (v->yStart < s_ymin) || (v->yStart > s_ymax) || (v->yEnd < s_ymin) || (v->yEnd > s_ymax))
+   {
+      return 0;
+   }
+   c[0] = CONVX(v->xStart);
+   c[1] = CONVY(v->yStart);
+   c[2] = CONVX(v->xEnd);
+   c[3] = CONVY(v->yEnd);
+#endif
+   return 1;
+}
+
+
+/******************************************************************
+   Draw a batch of vectors in the current colour.  Produces the
+   same commands as calling zvgFrameVector() for each in turn, but
+   vectors inside the clip window skip the clipping and clamping.
+*******************************************************************/
+uint32_t zvgFrameVectors(const vec_t *v, size_t n)
+{
+   size_t   i;
+   int      c[4];
+   uint32_t blank;
+
+   blank = ((s_last_r == 0) && (s_last_g == 0) && (s_last_b == 0));
+   for (i = 0; i < n; i++)
+   {
+      if (!s_clip_inside || !conv_inside(&v[i], c))
+      {
+         zvgFrameVector(v[i].xStart, v[i].yStart, v[i].xEnd, v[i].yEnd);
+         continue;
+      }
+      rgb_put();
+      if ((c[0] != s_last_x) || (c[1] != s_last_y))
+      {
+         cmd_put((FLAG_XY << 29) | (1 << 28) | ((c[0] & 0x3fff) << 14) | (c[1] & 0x3fff));
+      }
+      cmd_put((FLAG_XY << 29) | ((blank & 0x1) << 28) | ((c[2] & 0x3fff) << 14) | (c[3] & 0x3fff));
+      s_last_x = c[2];
+      s_last_y = c[3];
+   }
+   return 0;
+}
+
+
+/******************************************************************
+   Draw a strip of joined vectors through n points, given as x,y
+   pairs, in the current colour.  Produces the same commands as
+   calling zvgFrameVector() for each vector in turn, but when the
+   whole strip is inside the clip window each point is converted
+   once, and only the first can need a blank move to it.
+*******************************************************************/
+uint32_t zvgFrameStrip(const int *xy, size_t n)
+{
+   size_t   i;
+   int      x, y;
+   uint32_t blank;
+
+   if (n < 2)
+   {
+      return 0;
+   }
+   for (i = 0; s_clip_inside && (i < n); i++)
+   {
+      if ((xy[i*2] < s_xmin) || (xy[i*2] > s_xmax) || (xy[i*2 + 1] < s_ymin) || (xy[i*2 + 1] > s_ymax))
+      {
+         break;
+      }
+   }
+   if (!s_clip_inside || (i < n))
+   {
+      for (i = 1; i < n; i++)
+      {
+         zvgFrameVector(xy[i*2 - 2], xy[i*2 - 1], xy[i*2], xy[i*2 + 1]);
+      }
+      return 0;
+   }
+   blank = ((s_last_r == 0) && (s_last_g == 0) && (s_last_b == 0));
+   rgb_put();
+   x = CONVX(xy[0]);
+   y = CONVY(xy[1]);
+   if ((x != s_last_x) || (y != s_last_y))
+   {
+      cmd_put((FLAG_XY << 29) | (1 << 28) | ((x & 0x3fff) << 14) | (y & 0x3fff));
+   }
+   for (i = 1; i < n; i++)
+   {
+      x = CONVX(xy[i*2]);
+      y = CONVY(xy[i*2 + 1]);
+      cmd_put((FLAG_XY << 29) | ((blank & 0x1) << 28) | ((x & 0x3fff) << 14) | (y & 0x3fff));
+   }
+   s_last_x = x;
+   s_last_y = y;
+   return 0;
+}
+
+
 /*****************************************************************************
 * Send the current buffer to the DVG
 *****************************************************************************/
@@ -645,16 +1344,63 @@ uint32_t zvgFrameSend(void)
 }
 
 
+/*****************************************************************************
+* Make the next frame a repeat of the last one sent, so the caller can skip
+* building a frame it knows is the same as the last. Nothing may be added to
+* the frame before zvgFrameSend(). Returns 0 if there is no last frame to
+* repeat (none sent yet, or it went out in packets), and the frame must be
+* built as usual.
+*****************************************************************************/
+int zvgFrameRepeat(void)
+{
+    s_repeat_next = (s_sent_idx >= 0);
+    return s_repeat_next;
+}
+
+
+/*****************************************************************************
+* Report how many unchanged frames were repeated rather than built again, and
+* how many bytes of them weren't written to the DVG at all.
+*****************************************************************************/
+void zvgFrameRepeatStats(uint32_t *frames, uint32_t *bytes)
+{
+    *frames = s_saved_frames;
+    *bytes  = s_saved_bytes;
+}
+
+
+/*****************************************************************************
+* Report frames that had vectors dropped because they didn't fit. Large
+* frames are sent to the DVG in several packets, so this is always zero.
+*****************************************************************************/
+void zvgFrameOverflowStats(uint32_t *frames, uint32_t *bytes)
+{
+    *frames = 0;
+    *bytes  = 0;
+}
+
+
+/*****************************************************************************
+* Report frames that were ready before the writer thread had a buffer free,
+* and the total time (in ms) spent waiting for one.
+*****************************************************************************/
+void zvgFrameStallStats(uint32_t *frames, uint32_t *ms)
+{
+    *frames = s_tx_stalls;
+    *ms     = (uint32_t)(s_tx_stall_time / 1000000);
+}
+
+
 /*****************************************************************************
 * Read and display DVG settings
 *****************************************************************************/
 void zvgBanner(void)
 {
-   char value[16];
-   if (zvgGetOption("version",   value, sizeof(value)) == 0) printf("Firmware   : %s\n", value);
-   if (zvgGetOption("flipx",     value, sizeof(value)) == 0) printf("Flip X     : %s\n", value);
-   if (zvgGetOption("flipy",     value, sizeof(value)) == 0) printf("Flip Y     : %s\n", value);
-   if (zvgGetOption("swapxy",    value, sizeof(value)) == 0) printf("Swap XY    : %s\n", value);
-   if (zvgGetOption("bwDisplay", value, sizeof(value)) == 0) printf("B&W Monitor: %s\n", value);
-   if (zvgGetOption("crtSpeed",  value, sizeof(value)) == 0) printf("CRT Speed  : %s\n", value);
+   const dvg_caps_t *caps = zvgGetCaps();
+   if (caps->have & DVG_HAVE_VERSION)   printf("Firmware   : %s\n", caps->version);
+   if (caps->have & DVG_HAVE_FLIPX)     printf("Flip X     : %s\n", caps->flipx ? "true" : "false");
+   if (caps->have & DVG_HAVE_FLIPY)     printf("Flip Y     : %s\n", caps->flipy ? "true" : "false");
+   if (caps->have & DVG_HAVE_SWAPXY)    printf("Swap XY    : %s\n", caps->swapxy ? "true" : "false");
+   if (caps->have & DVG_HAVE_BWDISPLAY) printf("B&W Monitor: %s\n", caps->bwDisplay ? "true" : "false");
+   if (caps->have & DVG_HAVE_CRTSPEED)  printf("CRT Speed  : %d\n", caps->crtSpeed);
 }
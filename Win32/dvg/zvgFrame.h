@@ -6,6 +6,7 @@
 #define _ZVGFRAME_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include "timer.h"
 
 #ifdef __cplusplus
@@ -18,6 +19,47 @@ extern "C" {
 #define Y_MIN   (-384)
 #define Y_MAX   383
 
+// A vector for zvgFrameVectors(), laid out as four consecutive ints
+typedef struct
+{
+   int xStart, yStart, xEnd, yEnd;
+} vec_t;
+
+// USB-DVG settings, read from the DVG's info block when it is opened
+
+#define DVG_KEY_SIZE          24
+#define DVG_VALUE_SIZE        64
+#define DVG_CAPS_EXTRA        8     // keys we don't know about that are kept
+
+#define DVG_HAVE_VERSION      0x01  // bits in dvg_caps_t.have, set if the DVG sent that key
+#define DVG_HAVE_FLIPX        0x02
+#define DVG_HAVE_FLIPY        0x04
+#define DVG_HAVE_SWAPXY       0x08
+#define DVG_HAVE_BWDISPLAY    0x10
+#define DVG_HAVE_CRTSPEED     0x20
+#define DVG_HAVE_DEFAULTGAME  0x40
+
+typedef struct
+{
+   char     key[DVG_KEY_SIZE];
+   char     value[DVG_VALUE_SIZE];
+} dvg_opt_t;
+
+typedef struct
+{
+   int         valid;                     // info has been read since the DVG was opened
+   uint32_t    have;                      // DVG_HAVE_ bits
+   char        version[DVG_VALUE_SIZE];
+   int         flipx;
+   int         flipy;
+   int         swapxy;
+   int         bwDisplay;
+   int         crtSpeed;
+   char        defaultGame[DVG_VALUE_SIZE];
+   int         extra_count;
+   dvg_opt_t   extra[DVG_CAPS_EXTRA];
+} dvg_caps_t;
+
 // Prototypes
 
 
@@ -25,10 +67,17 @@ extern void     zvgError(uint32_t err);
 extern int      zvgFrameOpen(void);
 extern void     zvgFrameClose(void);
 extern int      zvgGetOption(char *option, char *val_buf, uint32_t val_buf_size);
+extern const dvg_caps_t *zvgGetCaps(void);
 extern void     zvgFrameSetRGB15(uint8_t red, uint8_t green, uint8_t blue);
 extern void     zvgFrameSetClipWin(int xMin, int yMin, int xMax, int yMax);
 extern uint32_t zvgFrameVector(int xStart, int yStart, int xEnd, int yEnd);
+extern uint32_t zvgFrameVectors(const vec_t *v, size_t n);
+extern uint32_t zvgFrameStrip(const int *xy, size_t n);
 extern uint32_t zvgFrameSend(void);
+extern int      zvgFrameRepeat(void);
+extern void     zvgFrameRepeatStats(uint32_t *frames, uint32_t *bytes);
+extern void     zvgFrameOverflowStats(uint32_t *frames, uint32_t *bytes);
+extern void     zvgFrameStallStats(uint32_t *frames, uint32_t *ms);
 extern void     zvgBanner(void);
 
 #ifdef __cplusplus